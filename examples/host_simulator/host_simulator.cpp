@@ -0,0 +1,92 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The library running on a PC against a virtual PT6312 (host backend, see src/host/).
+ *
+ * Build & run from the root of the repository (VFD_TRANSPORT must be VFD_TRANSPORT_BITBANG):
+ *      g++ -std=gnu++11 -Isrc $(find src -name "*.cpp") examples/host_simulator/host_simulator.cpp \
+ *          -o host_simulator
+ *      ./host_simulator
+ */
+#include <stdio.h>
+#include "PT6312.h"
+
+// Virtual controller wired to the pins of global.h
+VFD_HostPT6312 vfd(VFD_CS_PORT, VFD_CS_PIN, VFD_SCLK_PORT, VFD_SCLK_PIN, VFD_DATA_PORT, VFD_DATA_PIN);
+
+// Key 1 of the 6th sample pressed between 10s and 10.5s of the virtual clock
+const VFD_HostKeyEvent keyScript[] = {
+    {10000000UL, 0x000001},
+    {10500000UL, 0x000000},
+};
+
+
+/**
+ * @brief Print the display memory of the virtual controller.
+ */
+void dumpDisplay(const char *title)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    // Send the queued bytes to the virtual controller first
+    VFD_txFence();
+    #endif
+
+    printf("%-14s mode: %2u grids, display %s, brightness %u |", title,
+           vfd.grids(), vfd.displayOn() ? "on " : "off", vfd.brightness());
+    for (uint8_t grid = 1; grid <= VFD_GRIDS; grid++) {
+        printf(" %04x", vfd.gridSegments(grid));
+    }
+    printf("\n");
+}
+
+
+int main()
+{
+    VFD_initialize();
+    dumpDisplay("initialize");
+
+    VFD_home();
+    VFD_writeString("HELLO", false);
+    dumpDisplay("writeString");
+
+    VFD_setBrightness(3);
+    dumpDisplay("setBrightness");
+
+    VFD_setLEDs(PT6312_LED1 | PT6312_LED3);
+    #if VFD_TX_QUEUE_SIZE > 0
+    VFD_txFence();
+    #endif
+    printf("LEDs on: 0x%x\n", vfd.ledsOn());
+
+    vfd.setSwitches(PT6312_SW2);
+    printf("Switches: 0x%x\n", VFD_getSwitches());
+
+    vfd.setKeyScript(keyScript, sizeof(keyScript) / sizeof(keyScript[0]));
+    while (VFD_hostNanos() < 11000000000ULL) {
+        uint8_t key = VFD_getKeyPressed();
+        if (key) {
+            printf("Key %u pressed at %llu ms\n", key, (unsigned long long)(VFD_hostNanos() / 1000000));
+            break;
+        }
+        _delay_ms(100);
+    }
+
+    printf("Bus: %u transmissions, %u commands, %u data bytes, %u bytes read\n",
+           vfd.transmissions, vfd.commands, vfd.dataBytes, vfd.readBytes);
+    printf("Virtual time: %llu us\n", (unsigned long long)(VFD_hostNanos() / 1000));
+    return 0;
+}
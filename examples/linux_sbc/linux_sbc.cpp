@@ -0,0 +1,140 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* The library on a Linux single-board computer (Linux backend, see src/linux/).
+ *
+ * Build from the root of the repository:
+ *      g++ -std=gnu++11 -DVFD_LINUX -Isrc $(find src -name "*.cpp") examples/linux_sbc/linux_sbc.cpp \
+ *          -o linux_sbc
+ *
+ * Run on the hardware (lines VFD_CS_LINE, VFD_SCLK_LINE, VFD_DATA_LINE of global.h):
+ *      ./linux_sbc --gpio /dev/gpiochip0
+ *      ./linux_sbc --spi /dev/spidev0.0      (VFD_TRANSPORT_LINUX, VFD_CS_LINE 0)
+ *
+ * Run & check against the mock GPIO chip (exit code 1 if the controller state is wrong):
+ *      ./linux_sbc --mock                    (gpiochip-like)
+ *      ./linux_sbc --mock-spi                (spidev-like, VFD_TRANSPORT_LINUX)
+ */
+#include <stdio.h>
+#include <string.h>
+#include "PT6312.h"
+
+static VFD_PT6312Model vfd;
+static bool mocked;
+static int failures;
+
+
+/**
+ * @brief Print the calls made to the GPIO interface by an operation.
+ */
+static void report(const char *operation, uint32_t calls_before)
+{
+    printf("%-14s %5u calls\n", operation, VFD_linuxGpioCalls() - calls_before);
+}
+
+
+/**
+ * @brief Test a state of the mock controller.
+ */
+static void check(const char *what, bool success)
+{
+    if (mocked && !success) {
+        printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *mode = (argc > 1) ? argv[1] : "--mock";
+    bool spi = !strcmp(mode, "--spi") || !strcmp(mode, "--mock-spi");
+
+    if (spi && VFD_Driver::transport != VFD_TRANSPORT_LINUX) {
+        fprintf(stderr, "spidev requires VFD_TRANSPORT_LINUX in global.h\n");
+        return 2;
+    }
+
+    static const uint8_t lines[] = {VFD_CS_LINE, VFD_SCLK_LINE, VFD_DATA_LINE};
+    static VFD_LinuxMockChip mock_chip(false);
+    static VFD_LinuxMockChip mock_spi(true);
+    static VFD_LinuxGpioChip chip;
+    static VFD_LinuxSpidev spidev;
+
+    if (!strcmp(mode, "--mock") || !strcmp(mode, "--mock-spi")) {
+        VFD_LinuxMockChip &mock = spi ? mock_spi : mock_chip;
+        mock.attach(vfd, VFD_CS_LINE, VFD_SCLK_LINE, VFD_DATA_LINE);
+        VFD_linuxSetGpio(&mock.gpio);
+        mocked = true;
+    }else if (!strcmp(mode, "--gpio") && argc > 2) {
+        if (!VFD_linuxGpioChipOpen(chip, argv[2], lines, sizeof(lines))) {
+            perror(argv[2]);
+            return 2;
+        }
+        VFD_linuxSetGpio(&chip.gpio);
+    }else if (!strcmp(mode, "--spi") && argc > 2) {
+        if (!VFD_linuxSpidevOpen(spidev, VFD_CS_LINE, argv[2])) {
+            perror(argv[2]);
+            return 2;
+        }
+        VFD_linuxSetGpio(&spidev.gpio);
+    }else{
+        fprintf(stderr, "usage: %s --mock | --mock-spi | --gpio <gpiochip> | --spi <spidev>\n", argv[0]);
+        return 2;
+    }
+
+    uint32_t calls = VFD_linuxGpioCalls();
+    VFD_initialize();
+    report("initialize", calls);
+    check("display mode", vfd.grids() == VFD_GRIDS);
+    check("display on", vfd.displayOn());
+
+    calls = VFD_linuxGpioCalls();
+    VFD_home();
+    VFD_writeString("HELLO", false);
+    report("writeString", calls);
+    check("display memory", !memcmp(vfd.memory, VFD_Driver::displayBuffer, VFD_Driver::displayMemory));
+
+    calls = VFD_linuxGpioCalls();
+    VFD_setBrightness(3);
+    report("setBrightness", calls);
+    check("brightness", vfd.brightness() == 3);
+
+    calls = VFD_linuxGpioCalls();
+    VFD_setLEDs(PT6312_LED1 | PT6312_LED3);
+    report("setLEDs", calls);
+    check("LEDs", vfd.ledsOn() == (PT6312_LED1 | PT6312_LED3));
+
+    vfd.setSwitches(PT6312_SW2);
+    calls = VFD_linuxGpioCalls();
+    uint8_t switches = VFD_getSwitches();
+    report("getSwitches", calls);
+    check("switches", switches == PT6312_SW2);
+
+    vfd.setKeys(0x010203);
+    calls = VFD_linuxGpioCalls();
+    uint32_t keys = VFD_getKeys();
+    report("getKeys", calls);
+    check("keys", keys == 0x010203);
+
+    printf("Switches: 0x%x, keys: 0x%06x\n", switches, (unsigned)keys);
+    if (mocked) {
+        printf("Bus: %u transmissions, %u commands, %u data bytes, %u bytes read\n",
+               vfd.transmissions, vfd.commands, vfd.dataBytes, vfd.readBytes);
+    }
+    return failures ? 1 : 0;
+}
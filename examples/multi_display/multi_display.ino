@@ -0,0 +1,79 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* 3 controllers on the same SCLK/DATA lines (PB1, PB2 with the default global.h),
+ * each one with its own CS/Strobe line:
+ *      - the default display configured in global.h (CS: PB0),
+ *      - a "1 char per grid" display of 5 grids (CS: PB3),
+ *      - a display of 4 grids with the layout of global.h (CS: PB4).
+ */
+#include "PT6312.h"
+#include "display_variants/variant_2_functions.h"
+
+VFD_DEFINE_PORT_PIN(CsPin2, B, 3);
+VFD_DEFINE_PORT_PIN(CsPin3, B, 4);
+
+typedef PT6312<CsPin2, VFD_SclkPin, VFD_DataPin, 5, VFD_Variant2::Layout, VFD_TRANSPORT> Display2;
+typedef PT6312<CsPin3, VFD_SclkPin, VFD_DataPin, 4, VFD_Layout, VFD_TRANSPORT> Display3;
+typedef VFD_Bus<VFD_Driver, Display2, Display3> Displays;
+
+bool tick = false;
+
+
+#if ENABLE_TIMER == 1
+/**
+ * @brief The background features (spinner, fades, key scanner) of the default driver
+ *      must not interleave with a transmission to the other controllers.
+ *      Replaces the default implementation that only tests the CS line of the default driver.
+ */
+bool VFD_busIdle(void)
+{
+    return Displays::isIdle();
+}
+#endif
+
+
+void setup(){
+    // Replaces VFD_initialize(): all the CS lines are configured before the first command
+    Displays::initialize();
+    #if ENABLE_TIMER == 1
+    VFD_timerStart();
+    #endif
+
+    Displays::setBrightness(5);
+}
+
+
+void loop(){
+    // Draw in the display buffers only...
+    Displays::holdAll();
+
+    VFD_home();
+    VFD_writeString("HELLO", false);
+
+    Display2::setGridCursor(1);
+    Display2::writeString((tick) ? "TICK " : "TOCK ", false);
+
+    Display3::setGridCursor(1);
+    Display3::writeString("WORLD", false);
+
+    // ...then refresh the 3 displays in one pass (only the modified bytes are sent)
+    Displays::flushAll();
+
+    tick = !tick;
+    _delay_ms(1000);
+}
@@ -20,43 +20,6 @@
  */
 #include "PT6312.h"
 
-char currentTime[] = "000655"; // 06h55m00s
-
-/**
- * @brief Refresh currentTime string with a time updated by 1 second.
- */
-void updateTime()
-{
-    // Read previous numbers from currentTime char array
-    // ASCII values of numbers start from 0x30 (0)
-    uint8_t seconds = (currentTime[0] - 0x30) * 10 + currentTime[1] - 0x30;
-    uint8_t hours   = (currentTime[2] - 0x30) * 10 + currentTime[3] - 0x30;
-    uint8_t minutes = (currentTime[4] - 0x30) * 10 + currentTime[5] - 0x30;
-
-    // Add 1 sec, recompute minutes and hours
-    seconds++;
-    if (seconds >= 60) {
-        seconds = 0;
-        minutes++;
-    }
-    if (minutes >= 60) {
-        minutes = 0;
-        hours++;
-    }
-    if (hours >= 24) {
-        hours = 0;
-    }
-
-    // Refresh the currentTime string
-    currentTime[0] = (seconds / 10) + 0x30;
-    currentTime[1] = (seconds % 10) + 0x30;
-    currentTime[2] = (hours / 10) + 0x30;
-    currentTime[3] = (hours % 10) + 0x30;
-    currentTime[4] = (minutes / 10) + 0x30;
-    currentTime[5] = (minutes % 10) + 0x30;
-}
-
-
 /**
  * @brief Function called at the end of each iteration of VFD_scrollText() function.
  */
@@ -93,6 +56,13 @@ void setup(){
     _delay_ms(3000);
 
     // Test dimming
+    #if ENABLE_TIMER == 1
+    // Smooth fades in background: down to the lowest setting, then back up, 3 seconds each
+    VFD_fadeTo(VFD_BRIGHTNESS_LEVEL(PT6312_BRT0), 3000);
+    while (VFD_fadeRunning()) {}
+    VFD_fadeTo(VFD_BRIGHTNESS_LEVEL_MAX, 3000);
+    while (VFD_fadeRunning()) {}
+    #else
     VFD_setBrightness(1);
     _delay_ms(1000);
     VFD_setBrightness(2);
@@ -105,20 +75,23 @@ void setup(){
     _delay_ms(1000);
     VFD_setBrightness(7);
     _delay_ms(1000);
+    #endif
 
     // Scrolling text
     VFD_home();
     VFD_scrollText("HELLO WORLD", &scrollCallback);
+
+    // Clock: seconds on the 1 char grids, hours & minutes around the colon symbol
+    VFD_clockSet(6, 55, 0);
+    VFD_clockStart("ssHHmm", 1, true);
 }
 
 
 void loop(){
     _digitalWrite(PORTB, PB4, _HIGH);
 
-    // Display time
-    updateTime();
-    VFD_home();
-    VFD_writeString(currentTime, true); // True is used to end the transmission
+    // Add 1 second to the clock: only the modified digits are sent
+    VFD_clockTick();
 
     // Spinning circle segments are on grid 1, MSB (address 1)
     VFD_busyWrapper(1);
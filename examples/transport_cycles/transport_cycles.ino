@@ -0,0 +1,146 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Cycles of the transport (VFD_TRANSPORT in global.h) measured on the MCU:
+ *      - cycles of VFD_command() for 1 byte (CS setup included),
+ *      - cycles of VFD_readByte() for 1 byte of a key read,
+ * are displayed alternately for 3 seconds each, averaged over MEASURES calls.
+ *
+ * Required in global.h: VFD_STATS set, ENABLE_TIMER not set (Timer1 is used here).
+ * The cycles are counted by Timer1 without prescaler (VFD_statsCycles() is replaced);
+ * the cost of the measurement itself is subtracted.
+ */
+#include "PT6312.h"
+
+#if VFD_STATS != 1 || ENABLE_TIMER == 1
+    #error "This sketch requires VFD_STATS and a free Timer1 (ENABLE_TIMER not set)!"
+#endif
+
+#define MEASURES    64
+
+// Timer1 overflows: high part of the cycle counter
+static volatile uint16_t timer_overflows;
+
+
+ISR(TIMER1_OVF_vect)
+{
+    timer_overflows++;
+}
+
+
+/**
+ * @brief Clock of the cycle counters of VFD_stats: Timer1 without prescaler extended
+ *      by its overflows (replaces the weak function of the library).
+ */
+uint32_t VFD_statsCycles(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    #if defined(TCCR1)
+    // ATtiny25/45/85: 8 bits timer
+    uint8_t count = TCNT1;
+    uint32_t high = timer_overflows;
+    // Overflow not handled yet (interrupts disabled)
+    if ((TIFR & (1 << TOV1)) && count < 0x80) {
+        high++;
+    }
+    SREG = sreg;
+    return (high << 8) | count;
+    #else
+    // ATmega: 16 bits timer
+    uint16_t count = TCNT1;
+    uint32_t high = timer_overflows;
+    if ((TIFR1 & (1 << TOV1)) && count < 0x8000) {
+        high++;
+    }
+    SREG = sreg;
+    return (high << 16) | count;
+    #endif
+}
+
+
+/**
+ * @brief Start Timer1 in normal mode without prescaler, overflow interrupt enabled.
+ */
+void timerStart(void)
+{
+    #if defined(TCCR1)
+    TCCR1 = (1 << CS10);
+    TIMSK |= (1 << TOIE1);
+    #else
+    TCCR1A = 0;
+    TCCR1B = (1 << CS10);
+    TIMSK1 |= (1 << TOIE1);
+    #endif
+    sei();
+}
+
+
+/**
+ * @return Cycles of 2 consecutive calls of VFD_statsCycles(): cost of a measurement.
+ */
+uint32_t measureOverhead(void)
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < MEASURES; i++) {
+        uint32_t start = VFD_statsCycles();
+        total += VFD_statsCycles() - start;
+    }
+    return total / MEASURES;
+}
+
+
+/**
+ * @brief Display a number of cycles with a one letter label (C: command, R: read).
+ */
+void displayCycles(char label, uint32_t cycles)
+{
+    VFD_clear();
+    VFD_home();
+    char text[2] = {label, '\0'};
+    VFD_writeString(text, false);
+    VFD_writeIntPosition(cycles, VFD_DISPLAYABLE_DIGITS - 1, 2, false);
+    _delay_ms(3000);
+}
+
+
+void setup(){
+    timerStart();
+    VFD_initialize();
+}
+
+
+void loop(){
+    uint32_t overhead = measureOverhead();
+
+    // 1 byte commands: display control, unchanged state
+    VFD_statsReset();
+    for (uint8_t i = 0; i < MEASURES; i++) {
+        VFD_command(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | PT6312_BRT_DEF, true);
+    }
+    uint32_t command_cycles = VFD_stats.commandCycles / VFD_stats.commands - overhead;
+
+    // Reads of the key matrix: PT6312_KEY_MEM bytes per read
+    VFD_statsReset();
+    for (uint8_t i = 0; i < MEASURES; i++) {
+        VFD_getKeys();
+    }
+    uint32_t read_cycles = VFD_stats.readCycles / VFD_stats.readBytes - overhead;
+
+    displayCycles('C', command_cycles);
+    displayCycles('R', read_cycles);
+}
@@ -0,0 +1,133 @@
+#!/bin/sh
+# PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+# Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Code size of the library on the MCU: the example sketch (examples/test_attiny_vfd) is built
+# with avr-gcc for both display variants at several revisions, each with its own global.h,
+# and the sizes are printed as a Markdown table.
+#
+# Usage, from the root of the repository:
+#      extras/avr_size/avr_size.sh [--check] [--readme] [<revision>...]
+# Revisions: git revisions, or "." for the checked-out tree (uncommitted changes included).
+# Default revisions: the baseline commit (first commit of the repository), the commit before
+# the driver class template (PT6312_driver.h), the commit that added it, and the checked-out tree.
+# --check: fail if the flash usage (text + data) of the checked-out tree is larger than the one
+# of the baseline commit, for any variant.
+# --readme: also write the table in README.md (between the avr_size markers).
+#
+# Environment: AVR_GXX (default: avr-g++), AVR_SIZE (default: avr-size), MCU (default: attiny85),
+# F_CPU (default: 8000000UL).
+set -e
+
+AVR_GXX=${AVR_GXX:-avr-g++}
+AVR_SIZE=${AVR_SIZE:-avr-size}
+MCU=${MCU:-attiny85}
+F_CPU=${F_CPU:-8000000UL}
+# Flags of the Arduino AVR core
+CXXFLAGS="-std=gnu++11 -Os -g0 -flto -fno-exceptions -fno-threadsafe-statics -ffunction-sections -fdata-sections"
+LDFLAGS="-Os -flto -fuse-linker-plugin -Wl,--gc-sections"
+
+check=0
+readme=0
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --check)  check=1 ;;
+        --readme) readme=1 ;;
+        *)        break ;;
+    esac
+    shift
+done
+
+baseline=$(git rev-list --max-parents=0 --abbrev-commit HEAD | tail -n 1)
+template=$(git log --diff-filter=A --format=%h -- src/PT6312_driver.h | tail -n 1)
+if [ $# -eq 0 ]; then
+    set -- "$baseline" "$template^" "$template" .
+fi
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+# Flash (text + data) & SRAM (data + bss) of the sketch at a revision, for a display variant
+build() {
+    dir="$work/$(echo "$1" | tr -c 'A-Za-z0-9\n' '_')_$2"
+    mkdir -p "$dir"
+    if [ "$1" = "." ]; then
+        cp -R src "$dir"
+    else
+        git archive "$1" src | tar -x -C "$dir"
+    fi
+    # Same program at each revision: the sketch of the baseline commit
+    git show "$baseline:examples/test_attiny_vfd/test_attiny_vfd.ino" > "$dir/sketch.cpp"
+    if [ "$2" = 2 ]; then
+        sed -i 's|^#define VFD_VARIANT_1|// #define VFD_VARIANT_1|; s|^// *#define VFD_VARIANT_2|#define VFD_VARIANT_2|' "$dir/src/global.h"
+    fi
+    # The sketch only uses the AVR headers: setup() & loop() are called like the Arduino core does
+    printf 'void setup(void);\nvoid loop(void);\nint main(void)\n{\n    setup();\n    for (;;) {\n        loop();\n    }\n}\n' > "$dir/main.cpp"
+
+    objects=""
+    for source in $(find "$dir/src" -name "*.cpp") "$dir/sketch.cpp" "$dir/main.cpp"; do
+        object="${source%.cpp}.o"
+        "$AVR_GXX" -mmcu="$MCU" -DF_CPU="$F_CPU" $CXXFLAGS -I"$dir/src" -c "$source" -o "$object" 2> "$dir/build.log" \
+            || { cat "$dir/build.log" >&2; exit 1; }
+        objects="$objects $object"
+    done
+    "$AVR_GXX" -mmcu="$MCU" $LDFLAGS $objects -o "$dir/sketch.elf"
+    "$AVR_SIZE" "$dir/sketch.elf" | awk 'NR == 2 { print $1 + $2, $2 + $3 }'
+}
+
+table="$work/table.md"
+{
+    echo "| Revision ($MCU) | Variant 1 flash | Variant 1 SRAM | Variant 2 flash | Variant 2 SRAM |"
+    echo "|----------|-----------------|----------------|-----------------|----------------|"
+} > "$table"
+for revision in "$@"; do
+    row=""
+    for variant in 1 2; do
+        sizes=$(build "$revision" $variant)
+        row="$row ${sizes% *} | ${sizes#* } |"
+        [ "$revision" = "$baseline" ] && eval "baseline_$variant=${sizes% *}"
+        [ "$revision" = "." ] && eval "tree_$variant=${sizes% *}"
+    done
+    if [ "$revision" = "." ]; then
+        name="Checked-out tree ($(git log -1 --format=%h))"
+    else
+        name=$(git log -1 --format='%h %s' "$revision" | cut -c 1-60)
+    fi
+    echo "| $name |$row" >> "$table"
+done
+cat "$table"
+
+if [ $readme -eq 1 ]; then
+    awk -v table="$table" '
+        /^<!-- avr_size -->$/  { print; while ((getline line < table) > 0) print line; skip = 1; next }
+        /^<!-- \/avr_size -->$/ { skip = 0 }
+        !skip
+    ' README.md > "$work/README.md"
+    cp "$work/README.md" README.md
+fi
+
+if [ $check -eq 1 ]; then
+    for variant in 1 2; do
+        [ -z "$(eval echo "\$baseline_$variant")" ] && eval "baseline_$variant=\$(build $baseline $variant | cut -d ' ' -f 1)"
+        [ -z "$(eval echo "\$tree_$variant")" ] && eval "tree_$variant=\$(build . $variant | cut -d ' ' -f 1)"
+        before=$(eval echo "\$baseline_$variant")
+        after=$(eval echo "\$tree_$variant")
+        if [ "$after" -gt "$before" ]; then
+            echo "Variant $variant: the checked-out tree is larger than the baseline commit $baseline: $after > $before bytes" >&2
+            exit 1
+        fi
+    done
+fi
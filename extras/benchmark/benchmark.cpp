@@ -0,0 +1,399 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Bus cost of the API, measured on the host backend (see src/host/).
+ *
+ * Each operation is run against a virtual PT6312; the bytes, SCLK edges, CS strobes,
+ * time spent in _delay_us() and bytes read from the flash memory (font & spinner tables)
+ * are written as a JSON report. If a baseline report is
+ * given, the program fails when an operation costs more than in the baseline.
+ * The program also fails when the display of an operation with an expected text is wrong.
+ *
+ * Build & run from the root of the repository with the default global.h:
+ *      g++ -std=gnu++11 -O2 -Isrc $(find src -name "*.cpp") extras/benchmark/benchmark.cpp \
+ *          -o vfd_benchmark
+ *      ./vfd_benchmark --baseline extras/benchmark/baseline.json --output report.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PT6312.h"
+#include "display_variants/variant_1_functions.h"
+#include "display_variants/variant_2_functions.h"
+
+// Default display (global.h)
+VFD_HostPT6312 vfd(VFD_CS_PORT, VFD_CS_PIN, VFD_SCLK_PORT, VFD_SCLK_PIN, VFD_DATA_PORT, VFD_DATA_PIN);
+
+// One display per variant, whatever the variant of global.h
+VFD_DEFINE_PORT_PIN(Variant1CsPin, D, 0);
+VFD_DEFINE_PORT_PIN(Variant1SclkPin, D, 1);
+VFD_DEFINE_PORT_PIN(Variant1DataPin, D, 2);
+VFD_DEFINE_PORT_PIN(Variant2CsPin, D, 3);
+VFD_DEFINE_PORT_PIN(Variant2SclkPin, D, 4);
+VFD_DEFINE_PORT_PIN(Variant2DataPin, D, 5);
+typedef PT6312<Variant1CsPin, Variant1SclkPin, Variant1DataPin, 4, VFD_Variant1::Layout> Variant1Display;
+typedef PT6312<Variant2CsPin, Variant2SclkPin, Variant2DataPin, 8, VFD_Variant2::Layout> Variant2Display;
+VFD_HostPT6312 variant1Vfd(PORTD, PD0, PORTD, PD1, PORTD, PD2);
+VFD_HostPT6312 variant2Vfd(PORTD, PD3, PORTD, PD4, PORTD, PD5);
+
+
+/**
+ * Operations
+ */
+static void prepareNothing(void) {}
+
+static void prepareDefault(void)
+{
+    VFD_clear();
+    VFD_home();
+}
+
+static void runInitialize(void)        { VFD_initialize(); }
+static void runWriteString(void)       { VFD_writeString("HELLO", false); }
+static void runWriteStringLabel(void)  { VFD_writeString("PLAY", false); }
+static void runWriteStringColon(void)  { VFD_writeString("123456", true); }
+static void runWriteIntNegative(void)  { VFD_writeInt(-12345, 6, true); }
+static void runWriteIntPositive(void)  { VFD_writeInt(123456, 6, true); }
+static void runWriteFixed(void)        { VFD_writeFixed(-2345, 2, 6, false); }
+static void runWriteFixedShort(void)   { VFD_writeFixed(12345, 2, 4, false); }
+static void runWriteHex(void)          { VFD_writeHex(0xBEEF, 6, false); }
+static void runClear(void)             { VFD_clear(); }
+static void runFlushClean(void)        { VFD_flush(); }
+static void runDisplayAllSegments(void){ VFD_displayAllSegments(); }
+static void runSetBrightness(void)     { VFD_setBrightness(3); }
+static void runScrollText(void)        { VFD_scrollText("HELLO WORLD"); }
+static void runBusyWrapper(void)       { VFD_busyWrapper(1); }
+static void runSpinnerFrame(void)
+{
+    VFD_busySpinningCircleFrame(1, 2, 0);
+    VFD_flushLayers();
+}
+static void runSetLEDs(void)           { VFD_setLEDs(PT6312_LED1 | PT6312_LED3); }
+static void runGetKeys(void)           { VFD_getKeys(); }
+static void runGetSwitches(void)       { VFD_getSwitches(); }
+
+// Text under the animation
+static void prepareText(void)
+{
+    prepareDefault();
+    VFD_writeString("HELLO", false);
+}
+
+// Previous content of the reserved characters
+static void prepareWriteFixedShort(void)
+{
+    prepareDefault();
+    VFD_writeString("XXXXXX", false);
+    VFD_home();
+}
+
+static void prepareWriteStringSame(void)
+{
+    VFD_home();
+    VFD_writeString("HELLO", false);
+    VFD_home();
+}
+
+// Same label as runWriteStringLabel(), encoded once
+static VFD_EncodedString label;
+
+static void prepareEncoded(void)
+{
+    prepareDefault();
+    VFD_encodeString("PLAY", false, label);
+}
+
+static void runWriteEncoded(void)       { VFD_writeEncoded(label, 1); }
+
+// Write mode is restored by the first write after a key read
+static void prepareAfterGetKeys(void)
+{
+    prepareDefault();
+    VFD_getKeys();
+}
+
+static void prepareVariant1(void)
+{
+    Variant1Display::clear();
+    Variant1Display::setGridCursor(1);
+}
+
+static void runVariant1WriteString(void) { Variant1Display::writeString("HELLO1", true); }
+
+static void prepareVariant2(void)
+{
+    Variant2Display::clear();
+    Variant2Display::setGridCursor(1);
+}
+
+static void runVariant2WriteString(void) { Variant2Display::writeString("HELLO 12", true); }
+
+struct Operation
+{
+    const char     *name;
+    void           (*prepare)(void);
+    void           (*run)(void);
+    VFD_HostPT6312 *controller;
+    // Text displayed by the operation from the 1st grid of the default display (NULL: not checked)
+    const char     *expected;
+};
+
+static const Operation operations[] = {
+    {"initialize",              prepareNothing,         runInitialize,          &vfd, NULL},
+    {"writeString",             prepareDefault,         runWriteString,         &vfd, NULL},
+    {"writeString.colon",       prepareDefault,         runWriteStringColon,    &vfd, NULL},
+    {"writeString.unchanged",   prepareWriteStringSame, runWriteString,         &vfd, NULL},
+    {"writeString.afterGetKeys",prepareAfterGetKeys,    runWriteString,         &vfd, NULL},
+    {"writeString.label",       prepareDefault,         runWriteStringLabel,    &vfd, NULL},
+    {"writeEncoded.label",      prepareEncoded,         runWriteEncoded,        &vfd, NULL},
+    {"writeString.variant1",    prepareVariant1,        runVariant1WriteString, &variant1Vfd, NULL},
+    {"writeString.variant2",    prepareVariant2,        runVariant2WriteString, &variant2Vfd, NULL},
+    {"writeInt.negative",       prepareDefault,         runWriteIntNegative,    &vfd, NULL},
+    {"writeInt.positive",       prepareDefault,         runWriteIntPositive,    &vfd, NULL},
+    {"writeFixed",              prepareDefault,         runWriteFixed,          &vfd,
+                                VFD_Layout::decimalPoint ? "-23.45" : "-00023"},
+    {"writeFixed.short",        prepareWriteFixedShort, runWriteFixedShort,     &vfd, "0123XX"},
+    {"writeHex",                prepareDefault,         runWriteHex,            &vfd, NULL},
+    {"clear",                   prepareNothing,         runClear,               &vfd, NULL},
+    {"flush.clean",             prepareNothing,         runFlushClean,          &vfd, NULL},
+    {"displayAllSegments",      prepareDefault,         runDisplayAllSegments,  &vfd, NULL},
+    {"setBrightness",           prepareNothing,         runSetBrightness,       &vfd, NULL},
+    {"scrollText",              prepareDefault,         runScrollText,          &vfd, NULL},
+    {"busyWrapper",             prepareDefault,         runBusyWrapper,         &vfd, NULL},
+    {"flushLayers.spinnerFrame",prepareText,            runSpinnerFrame,        &vfd, NULL},
+    {"setLEDs",                 prepareNothing,         runSetLEDs,             &vfd, NULL},
+    {"getKeys",                 prepareNothing,         runGetKeys,             &vfd, NULL},
+    {"getSwitches",             prepareNothing,         runGetSwitches,         &vfd, NULL},
+};
+
+#define OPERATIONS  (sizeof(operations) / sizeof(operations[0]))
+
+struct Cost
+{
+    uint32_t bytes;
+    uint32_t sclkEdges;
+    uint32_t strobes;
+    double   delayUs;
+    uint32_t flashReads;
+};
+
+#define METRICS     5
+
+static const char *metrics[METRICS] = {"bytes", "sclk_edges", "strobes", "delay_us", "flash_reads"};
+
+static double metric(const Cost &cost, uint8_t index)
+{
+    switch (index) {
+    case 0:  return cost.bytes;
+    case 1:  return cost.sclkEdges;
+    case 2:  return cost.strobes;
+    case 3:  return cost.delayUs;
+    default: return cost.flashReads;
+    }
+}
+
+
+/**
+ * @brief Run an operation and get its bus cost.
+ */
+static Cost measure(const Operation &operation)
+{
+    operation.prepare();
+
+    VFD_HostPT6312 *controller = operation.controller;
+    controller->resetStatistics();
+    uint64_t bus_start   = VFD_hostBusNanos();
+    uint32_t flash_start = VFD_hostFlashReads();
+
+    operation.run();
+
+    Cost cost;
+    cost.bytes      = controller->commands + controller->dataBytes + controller->readBytes;
+    cost.sclkEdges  = controller->sclkEdges;
+    cost.strobes    = controller->transmissions;
+    cost.delayUs    = (VFD_hostBusNanos() - bus_start) / 1000.0;
+    cost.flashReads = VFD_hostFlashReads() - flash_start;
+    return cost;
+}
+
+
+/**
+ * @brief Test the display memory of the default display after an operation:
+ *      it must be the one drawn by VFD_writeString() for the expected text.
+ */
+static bool checkDisplay(const Operation &operation)
+{
+    uint8_t memory[VFD_HOST_PT6312_MEM];
+    memcpy(memory, vfd.memory, sizeof(memory));
+
+    prepareDefault();
+    VFD_writeString(operation.expected, false);
+    return !memcmp(memory, vfd.memory, sizeof(memory));
+}
+
+
+/**
+ * @brief Get a number from a line of a report: "key": value
+ * @return False if the key is not in the line.
+ */
+static bool readNumber(const char *line, const char *key, double &value)
+{
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *position = strstr(line, pattern);
+    if (!position) {
+        return false;
+    }
+    value = strtod(position + strlen(pattern), NULL);
+    return true;
+}
+
+
+/**
+ * @brief Find the costs of an operation in a baseline report (1 operation per line).
+ * @return False if the operation is not in the report.
+ */
+static bool readBaseline(FILE *baseline, const char *name, double values[METRICS])
+{
+    char line[512];
+    char pattern[80];
+    snprintf(pattern, sizeof(pattern), "\"name\": \"%s\"", name);
+
+    rewind(baseline);
+    while (fgets(line, sizeof(line), baseline)) {
+        if (!strstr(line, pattern)) {
+            continue;
+        }
+        for (uint8_t i = 0; i < METRICS; i++) {
+            if (!readNumber(line, metrics[i], values[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--baseline <report.json>] [--output <report.json>]\n", program);
+}
+
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_path = NULL;
+    const char *output_path   = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--baseline") && i + 1 < argc) {
+            baseline_path = argv[++i];
+        }else if (!strcmp(argv[i], "--output") && i + 1 < argc) {
+            output_path = argv[++i];
+        }else{
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    FILE *baseline = NULL;
+    if (baseline_path && !(baseline = fopen(baseline_path, "r"))) {
+        perror(baseline_path);
+        return 2;
+    }
+    FILE *output = stdout;
+    if (output_path && !(output = fopen(output_path, "w"))) {
+        perror(output_path);
+        return 2;
+    }
+
+    Variant1Display::initialize();
+    Variant2Display::initialize();
+
+    // Costs of the default display depend on global.h
+    char config[128];
+    snprintf(config, sizeof(config), "  \"config\": {\"variant\": %d, \"grids\": %d, \"displayable_digits\": %d},\n",
+             #if defined(VFD_VARIANT_1)
+             1,
+             #else
+             2,
+             #endif
+             VFD_GRIDS, VFD_DISPLAYABLE_DIGITS);
+
+    if (baseline) {
+        char line[512];
+        bool same_config = false;
+        while (fgets(line, sizeof(line), baseline)) {
+            if (!strcmp(line, config)) {
+                same_config = true;
+            }
+        }
+        if (!same_config) {
+            fprintf(stderr, "The baseline was not made with the same global.h configuration:\n%s", config);
+            return 2;
+        }
+    }
+
+    int regressions = 0;
+
+    fprintf(output, "{\n%s", config);
+    fprintf(output, "  \"operations\": [\n");
+
+    for (uint8_t i = 0; i < OPERATIONS; i++) {
+        Cost cost = measure(operations[i]);
+        if (operations[i].expected && !checkDisplay(operations[i])) {
+            fprintf(stderr, "%-24s WRONG DISPLAY: \"%s\" expected\n", operations[i].name, operations[i].expected);
+            regressions++;
+        }
+
+        fprintf(output, "    {\"name\": \"%s\", \"bytes\": %u, \"sclk_edges\": %u, \"strobes\": %u, \"delay_us\": %.1f, \"flash_reads\": %u}%s\n",
+                operations[i].name, cost.bytes, cost.sclkEdges, cost.strobes, cost.delayUs, cost.flashReads,
+                (i + 1U < OPERATIONS) ? "," : "");
+
+        if (!baseline) {
+            continue;
+        }
+        double reference[METRICS];
+        if (!readBaseline(baseline, operations[i].name, reference)) {
+            fprintf(stderr, "%-24s not in the baseline\n", operations[i].name);
+            continue;
+        }
+        for (uint8_t m = 0; m < METRICS; m++) {
+            // delay_us is rounded to 0.1us in the reports
+            if (metric(cost, m) > reference[m] + 0.05) {
+                fprintf(stderr, "%-24s REGRESSION %s: %.1f > %.1f (baseline)\n",
+                        operations[i].name, metrics[m], metric(cost, m), reference[m]);
+                regressions++;
+            }else if (metric(cost, m) < reference[m] - 0.05) {
+                fprintf(stderr, "%-24s improvement %s: %.1f < %.1f (baseline)\n",
+                        operations[i].name, metrics[m], metric(cost, m), reference[m]);
+            }
+        }
+    }
+
+    fprintf(output, "  ]\n}\n");
+
+    if (output != stdout) {
+        fclose(output);
+    }
+    if (baseline) {
+        fclose(baseline);
+        fprintf(stderr, "%d regression(s)\n", regressions);
+    }
+    return regressions ? 1 : 0;
+}
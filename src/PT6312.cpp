@@ -20,303 +20,656 @@
  */
 #include "PT6312.h"
 
-uint8_t grid_cursor;
+volatile bool vfd_bus_locked;
 
-// Select font & functions according to global.h setting
+// Selected font & functions (see global.h)
 #if defined(VFD_VARIANT_1)
-    #include "display_variants/variant_1_font.h"
     #warning "enabled default VFD config"
 #elif defined(VFD_VARIANT_2)
-    #include "display_variants/variant_2_font.h"
     #warning "enabled variant VFD config"
-#else
-    #error "Display variant not implemented!"
+#endif
+
+#if VFD_TRANSPORT == VFD_TRANSPORT_USI
+    // Minimal SCLK pulse width of the controller is 400ns; the strobe loop
+    // takes ~5 cycles per edge, pad it on fast MCUs.
+    #define VFD_USI_PAD_CYCLES  (F_CPU / 2500000UL)
+#elif VFD_TRANSPORT == VFD_TRANSPORT_SPI
+    // SCLK max frequency of the controller is ~1MHz
+    #if F_CPU <= 2000000UL
+        #define VFD_SPI_CLOCK_BITS  (0) // F_CPU/4 (SPI2X gives F_CPU/2)
+        #define VFD_SPI_2X          (F_CPU <= 1000000UL)
+    #elif F_CPU <= 4000000UL
+        #define VFD_SPI_CLOCK_BITS  (0)
+        #define VFD_SPI_2X          0
+    #elif F_CPU <= 8000000UL
+        #define VFD_SPI_CLOCK_BITS  (1 << SPR0) // F_CPU/8 with SPI2X
+        #define VFD_SPI_2X          1
+    #elif F_CPU <= 16000000UL
+        #define VFD_SPI_CLOCK_BITS  (1 << SPR0) // F_CPU/16
+        #define VFD_SPI_2X          0
+    #else
+        #define VFD_SPI_CLOCK_BITS  (1 << SPR1) // F_CPU/32 with SPI2X
+        #define VFD_SPI_2X          1
+    #endif
+#elif (VFD_TRANSPORT != VFD_TRANSPORT_BITBANG) && (VFD_TRANSPORT != VFD_TRANSPORT_LINUX)
+    #error "Transport not implemented!"
 #endif
 
 
 /**
  * @brief Configure the controller and the pins of the MCU.
+ *      Waits for the startup of the controller (see VFD_POWER_UP_DELAY and VFD_POWER_UP_PROBE
+ *      in global.h).
+ *      Starts the timer interrupt if ENABLE_TIMER is set.
+ * @see PT6312::initialize(), VFD_initializeStart() for a non-blocking version.
  */
 void VFD_initialize(void)
 {
-    // Configure pins
-    _pinMode(VFD_CS_DDR, VFD_CS_PIN, _OUTPUT);
-    _pinMode(VFD_SCLK_DDR, VFD_SCLK_PIN, _OUTPUT);
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
-
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH);
-    _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
-
-    // Waiting for the VFD driver to startup
-    _delay_ms(500);
-
-    // Configure the controller
-    // Set display mode (number of digits & segments)
-    #if VFD_GRIDS == 4
-        VFD_command(PT6312_GR4_SEG16, 1);  // 4 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 5
-        VFD_command(PT6312_GR5_SEG16, 1);  // 5 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 6
-        VFD_command(PT6312_GR6_SEG16, 1);  // 6 digits, 16 segments
-        #define VFD_SEGMENTS 16
-    #elif VFD_GRIDS == 7
-        VFD_command(PT6312_GR7_SEG15, 1);  // 7 digits, 15 segments
-        #define VFD_SEGMENTS 15
-    #elif VFD_GRIDS == 8
-        VFD_command(PT6312_GR8_SEG14, 1);  // 8 digits, 14 segments
-        #define VFD_SEGMENTS 14
-    #elif VFD_GRIDS == 9
-        VFD_command(PT6312_GR9_SEG13, 1);  // 9 digits, 13 segments
-        #define VFD_SEGMENTS 13
-    #elif VFD_GRIDS == 10
-        VFD_command(PT6312_GR10_SEG12, 1); // 10 digits, 12 segments
-        #define VFD_SEGMENTS 12
-    #elif VFD_GRIDS == 11
-        VFD_command(PT6312_GR11_SEG11, 1); // 11 digits, 11 segments
-        #define VFD_SEGMENTS 11
+    VFD_Driver::initialize();
+
+    #if ENABLE_TIMER == 1
+    VFD_timerStart();
     #endif
+}
 
-    VFD_resetDisplay();
 
-    grid_cursor = 1;
-}
+/**
+ * State of the asynchronous initialization
+ * @see VFD_initializeStart()
+ */
+static struct {
+    bool     pending;
+    uint32_t start_ms;  // Time of VFD_initializeStart()
+} startup;
 
 
 /**
- * @brief Reset the controller
- *      - Turn on the display by setting the brightness
- *      - Init default command mode (write to memory, auto increment the memory address)
+ * @brief Start the initialization without waiting for the startup of the controller:
+ *      the pins of the MCU are configured, the controller is configured later by
+ *      VFD_initializeTick(), which must be called from the main loop (or a timer callback).
+ *      In the meantime, the drawing functions only update the display buffer
+ *      (see PT6312::flushHeld); its content is sent once the controller is configured.
+ *      Ex:
+ *          VFD_initializeStart(millis());
+ *          VFD_writeString("HELLO", false);
+ *          ...
+ *          if (VFD_initializeTick(millis())) { // Display ready
+ *              ...
+ *          }
+ * @param now_ms Current time in milliseconds (Ex: millis() on Arduino).
+ * @see VFD_initialize() for the blocking version.
  */
-void VFD_resetDisplay(void)
+void VFD_initializeStart(uint32_t now_ms)
 {
-    // Turn on the display
-    // Display control cmd, display on/off, default brightness
-    VFD_displayOn(PT6312_BRT_DEF);
+    VFD_Driver::configurePins();
 
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+    VFD_Driver::flushHeld = true;
+    VFD_Driver::setGridCursor(1);
+
+    startup.start_ms = now_ms;
+    startup.pending  = true;
 }
 
 
 /**
- * @brief Set display brightness
- * @param brightness Valid range 0..7
- *      for 1/16, 2/16, 4/16, 10/16, 11/16, 12/16, 13/16, 14/16 dutycycles.
+ * @brief Configure the controller once its startup is over: VFD_POWER_UP_DELAY milliseconds
+ *      after VFD_initializeStart(), or as soon as it answers if VFD_POWER_UP_PROBE is set.
+ *      Then the display buffer is sent and the timer interrupt is started if ENABLE_TIMER is set.
+ * @param now_ms Current time in milliseconds, from the same clock as for VFD_initializeStart().
+ * @return true when the display is ready; until then only the drawing functions may be used
+ *      (key and switch reads, LEDs and brightness commands would be lost).
  */
-void VFD_setBrightness(const uint8_t brightness)
+bool VFD_initializeTick(uint32_t now_ms)
 {
-    // Display control cmd, display on/off, brightness
-    // mask invalid bits with PT6312_BRT_MSK
-    VFD_command(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | (brightness & PT6312_BRT_MSK), true);
+    if (!startup.pending) {
+        return true;
+    }
+    if ((now_ms - startup.start_ms) < VFD_POWER_UP_DELAY
+        #if VFD_POWER_UP_PROBE == 1
+        && !VFD_Driver::isResponding()
+        #endif
+        ) {
+        return false;
+    }
+    startup.pending = false;
+
+    // The grid cursor is kept for the drawing made during the startup
+    uint8_t cursor = grid_cursor;
+    VFD_Driver::flushHeld = false;
+    VFD_Driver::configureController();
+    grid_cursor = cursor;
 
-    // Don't really know why, but this line (or a set mode command) is required to wake up the display
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+    #if ENABLE_TIMER == 1
+    VFD_timerStart();
+    #endif
+    return true;
 }
 
 
 /**
- * @brief Clear the display by turning off all segments
- *      If ENABLE_ICON_BUFFER is enabled, icons will be cleared by this function
- *      but the buffer is preserved. i.e the icons will reappear with the next call
- *      to VFD_writeString(), VFD_writeInt() or VFD_busySpinningCircle().
- * @see VFD_clearIcons()
+ * @brief Convert a number to packed BCD without division (double dabble:
+ *      the bits are shifted in the BCD digits, 3 is added to the digits >= 5 before
+ *      each shift so that they carry into the next digit).
+ * @param value Number to convert.
+ * @param bcd 10 BCD digits, 2 per byte; units in the low nibble of bcd[0].
+ * @return Number of significant digits (0 for 0).
  */
-void VFD_clear(void)
+static uint8_t VFD_toBCD(uint32_t value, uint8_t bcd[5])
 {
-    // Set addr to 1st memory cell, no CS assertion
-    VFD_setGridCursor(1, false);
+    for (uint8_t i = 0; i < 5; i++) {
+        bcd[i] = 0;
+    }
+    if (value == 0) {
+        return 0;
+    }
 
-    for(uint8_t i=0; i<VFD_GRIDS; i++){
-        // Display a segment
-        VFD_command(0, false);
-        VFD_command(0, false);
+    // Skip the leading zeros
+    uint8_t bits = 32;
+    while (!(value & 0xFF000000UL)) {
+        value <<= 8;
+        bits   -= 8;
+    }
+    while (!(value & 0x80000000UL)) {
+        value <<= 1;
+        bits--;
     }
-    VFD_CSSignal();
-    grid_cursor = VFD_GRIDS;
+
+    // Bytes of bcd in use
+    uint8_t used = 1;
+    while (bits--) {
+        for (uint8_t i = 0; i < used; i++) {
+            uint8_t digits = bcd[i];
+            if ((digits & 0x0F) >= 0x05) {
+                digits += 0x03;
+            }
+            if ((digits & 0xF0) >= 0x50) {
+                digits += 0x30;
+            }
+            bcd[i] = digits;
+        }
+
+        uint8_t carry = value >> 31;
+        value <<= 1;
+        for (uint8_t i = 0; i < used; i++) {
+            uint8_t digits = bcd[i];
+            bcd[i] = (digits << 1) | carry;
+            carry  = digits >> 7;
+        }
+        if (carry) {
+            bcd[used++] = 1;
+        }
+    }
+    return (bcd[used - 1] & 0xF0) ? used * 2 : used * 2 - 1;
 }
 
 
 /**
- * @brief Set the cursor on the controller memory according to the given grid position.
- *      The first address of a grid will be selected for writing.
- *      Should be used BEFORE sending segments data.
- *      Ex: If PT6312_BYTES_PER_GRID == 2 (default), position 1 relies on the first grid,
- *      the memory address on the controller will be 0.
- *      Position 2 relies on the 2nd grid, the address will be 2 (2 bytes further).
- * @param position Position where the next segments will be written.
- *      Valid range 1..VFD_GRIDS.
- *      If position == VFD_GRIDS + 1: The first grid will be selected.
- *      If position > VFD_GRIDS + 1 or VFD_GRIDS == 0: The last grid will be selected.
- * @param cmd (Optional) Boolean transmitted to VFD_command();
- *      If True the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after setting the address.
- *      Default: false
+ * @brief Write digits stored as nibbles (BCD or hexadecimal), from the most significant one.
+ *      The string is cut from the left if it doesn't fit in the remaining
+ *      displayable digits (the minus sign is kept).
+ * @param nibbles 10 digits, 2 per byte; digit 0 in the low nibble of nibbles[0].
+ * @param first Number of the last digit to write.
+ * @param count Number of digits to write.
+ * @param negative Prefix the digits with a minus sign.
+ * @param frac_digits Number of digits after the decimal point (0: no point).
+ * @param colon_symbol See VFD_writeString().
  */
-void VFD_setGridCursor(uint8_t position, bool cmd)
+static void VFD_writeNibbles(const uint8_t nibbles[5], uint8_t first, uint8_t count,
+                             bool negative, uint8_t frac_digits, bool colon_symbol)
 {
-    if (position > VFD_GRIDS) {
-        if (position == VFD_GRIDS + 1) {
-            position = 1;
-        }else{
-            position = VFD_GRIDS;
-        }
-    }else if (position == 0) {
-        position = VFD_GRIDS;
+    uint8_t remaining_space = (grid_cursor <= VFD_DISPLAYABLE_DIGITS) ? VFD_DISPLAYABLE_DIGITS - grid_cursor + 1 : 0;
+    uint8_t length          = negative + count + (frac_digits ? 1 : 0);
+    uint8_t size            = (length > remaining_space) ? remaining_space : length;
+    char    string[VFD_DISPLAYABLE_DIGITS + 1];
+
+    string[size] = '\0';
+
+    uint8_t end = 0;
+    if (negative && size) {
+        string[0] = '-';
+        end = 1;
     }
 
-    grid_cursor = position;
+    uint8_t digit = first;
+    for (uint8_t i = size; i > end; ) {
+        if (frac_digits && digit == first + frac_digits) {
+            string[--i]  = '.';
+            frac_digits = 0;
+            continue;
+        }
+        uint8_t value = (digit < 10) ? (nibbles[digit >> 1] >> ((digit & 1) << 2)) & 0x0F : 0;
+        string[--i] = (value < 10) ? '0' + value : 'A' - 10 + value;
+        digit++;
+    }
 
-    // Map position to memory (x bytes per digit)
-    position = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
-    // Address setting command: set an address of the display memory (0 to 15, 5 lowest bits)
-    VFD_command(PT6312_ADDR_SET_CMD | (position & PT6312_ADDR_MSK), cmd);
+    VFD_writeString(string, colon_symbol);
 }
 
 
 /**
  * @brief Write a number
+ *      The number is converted without division (see VFD_toBCD()).
  * @param number Number to display. Can be negative.
  * @param digits_number Number of reserved characters to represent the given number.
  *      If the number is negative, the minus sign '-' will be counted in the digits_number;
  *      thus the digit_number is always respected.
  *      If the number representation uses more space than digits_number,
- *      it will be divided by 10 until it fits in the reserved space.
+ *      its last digits are discarded until it fits in the reserved space.
  *      If the number representation uses less space than digits_number,
  *      it will be padded with zeros.
  * @param colon_symbol Boolean set to true to display the special colon symbol
  *      segment if possible (See VFD_writeString()).
+ * @note The string is cut from the left if it doesn't fit in the remaining displayable digits.
+ *      Ex: VFD_writeInt(-123456, 7, true); on a 6 digits display will display: -23456
  */
 void VFD_writeInt(int32_t number, int8_t digits_number, bool colon_symbol)
 {
-    int16_t number_temp = number;
-    uint8_t length      = 0;
-    bool    isNegative  = false;
-
-    // Find number of digits
-    // TODO: no check of uint8 overflow here or later (by adding minus sign)
-    while (number_temp != 0) {
-        length++;
-        number_temp /= 10;
-    }
-
-    // Reserve 1 space for the sign
-    // Note: If we don't want to count the sign in the digits_number restriction
-    //  move this block after the next block of length adjustments.
-    if (number < 0) {
-        // Switch to positive number
-        number = -number;
-        length++;
-        isNegative = true;
-    }
-
-    // Adjust the number to digits_number param
-    if (length < digits_number) {
-        // Add remaining wanted space (filled later by zeros)
-        length += digits_number - length;
-    } else if (length > digits_number) {
-        // Reduce the size of the number by discarding units
-        // Ex: 100 to 1 digit: 2 divisions by 10 are made
-        for (uint8_t i = 0; i < (length - digits_number); i++)
-        {
-            number /= 10;
+    VFD_writeFixed(number, 0, digits_number, colon_symbol);
+}
+
+
+/**
+ * @brief Write a fixed-point number
+ *      Ex: VFD_writeFixed(-2345, 2, 6, false); displays "-23.45",
+ *      VFD_writeFixed(5, 2, 4, false); displays "0.05" (display variant 2).
+ * @param value Number to display multiplied by 10^frac_digits. Can be negative.
+ * @param frac_digits Number of digits after the decimal point (range 0..9).
+ *      The decimal point is the '.' character of the font; with a font without it
+ *      (display variant 1), the decimals are discarded: only the integer part is displayed.
+ * @param digits_number Number of reserved characters (minus sign and decimal point included).
+ *      If the number representation uses more space than digits_number,
+ *      the decimals are discarded first (the decimal point with the last one),
+ *      then the last digits of the integer part.
+ *      If the number representation uses less space than digits_number,
+ *      it will be padded with zeros (Ex: VFD_writeFixed(12345, 2, 4, false); displays "0123").
+ * @param colon_symbol Boolean set to true to display the special colon symbol
+ *      segment if possible (See VFD_writeString()).
+ * @see VFD_writeInt()
+ */
+void VFD_writeFixed(int32_t value, uint8_t frac_digits, int8_t digits_number, bool colon_symbol)
+{
+    bool     negative  = value < 0;
+    uint32_t magnitude = negative ? -(uint32_t)value : (uint32_t)value;
+    uint8_t  bcd[5];
+    uint8_t  digits    = VFD_toBCD(magnitude, bcd);
+    uint8_t  first     = 0;
+    uint8_t  reserved  = (digits_number > 0) ? digits_number : 0;
+
+    if (frac_digits > 9) {
+        frac_digits = 9;
+    }
+    // At least 1 digit before the decimal point
+    if (frac_digits && digits <= frac_digits) {
+        digits = frac_digits + 1;
+    }
+    if (!VFD_Layout::decimalPoint) {
+        // No decimal point in the font: the integer part only
+        first       = frac_digits;
+        digits     -= frac_digits;
+        frac_digits = 0;
+    }
+
+    uint8_t length = negative + digits + (frac_digits ? 1 : 0);
+    // Discard the decimals
+    while (length > reserved && frac_digits) {
+        first++;
+        digits--;
+        frac_digits--;
+        length -= (frac_digits) ? 1 : 2;
+    }
+    // Discard the last digits of the integer part
+    if (length > reserved) {
+        uint8_t excess = length - reserved;
+        if (excess > digits) {
+            excess = digits;
         }
-        length = digits_number;
+        first  += excess;
+        digits -= excess;
+        length -= excess;
+    }
+    // Leading zeros (also when the decimal point has been discarded with the last decimal)
+    if (length < reserved) {
+        digits += reserved - length;
     }
 
-    // Avoid a memory overflow if digit is too long
-    // (since VFD_writeString doesn't control the size)
-    // WARNING: This code will cut the string from left (not from right like previous adjustments)
-    // Ex: VFD_writeInt(-123456, 7, true); on a 6 digits display.
-    // Will display: -23456 (The 1 is dropped here)
-    uint8_t remaining_space  = VFD_DISPLAYABLE_DIGITS - grid_cursor + 1;
-    uint8_t size             = ((length > remaining_space) ? remaining_space : length);
-    char    string[size + 1] = ""; // +1 for null byte
+    VFD_writeNibbles(bcd, first, digits, negative && reserved, frac_digits, colon_symbol);
+}
 
-    if (isNegative) {
-        string[0] = '-';
+
+/**
+ * @brief Write a number in hexadecimal (uppercase digits, no prefix)
+ * @param value Number to display.
+ * @param digits_number Number of reserved characters.
+ *      If the number representation uses more space than digits_number,
+ *      its last digits are discarded until it fits in the reserved space.
+ *      If the number representation uses less space than digits_number,
+ *      it will be padded with zeros.
+ * @param colon_symbol Boolean set to true to display the special colon symbol
+ *      segment if possible (See VFD_writeString()).
+ * @see VFD_writeInt()
+ */
+void VFD_writeHex(uint32_t value, int8_t digits_number, bool colon_symbol)
+{
+    // Nibbles in the same order as the BCD digits of VFD_toBCD()
+    uint8_t nibbles[5] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24), 0};
+    uint8_t digits     = 8;
+    uint8_t reserved   = (digits_number > 0) ? digits_number : 0;
+
+    while (digits && !((nibbles[(digits - 1) >> 1] >> (((digits - 1) & 1) << 2)) & 0x0F)) {
+        digits--;
     }
 
-    for (uint8_t i = size - 1; i >= (isNegative) ? 1 : 0; --i)
-    {
-        // Convert number to ASCII value
-        // PS: even if the modulo is 0, the displayed number will be 0
-        // => takes care of the digits_number param.
-        string[i] = (number % 10) + 0x30;
-        number   /= 10;
+    uint8_t first = 0;
+    if (digits > reserved) {
+        first = digits - reserved;
     }
+    VFD_writeNibbles(nibbles, first, reserved, false, 0, colon_symbol);
+}
 
-    VFD_writeString(string, colon_symbol);
+
+/**
+ * @brief Encode a string for the layout of the display, to write it later with
+ *      VFD_writeEncoded() without looking up the font again.
+ *      Useful for the texts displayed over and over (labels, menu entries).
+ *      Ex:
+ *          VFD_EncodedString play;
+ *          VFD_encodeString("PLAY", false, play);
+ *          ...
+ *          VFD_writeEncoded(play, 1);
+ * @param string String of characters present in the font; must be null terminated '\0'.
+ *      Characters beyond VFD_DISPLAYABLE_DIGITS are ignored.
+ * @param colon_symbol See VFD_writeString().
+ * @param handle Encoded string (VFD_Layout::Glyph words, see VFD_Layout::fontGlyph()).
+ * @return Number of encoded characters.
+ */
+uint8_t VFD_encodeString(const char *string, bool colon_symbol, VFD_EncodedString &handle)
+{
+    uint8_t length = 0;
+
+    while ((*string > '\0') && (length < VFD_DISPLAYABLE_DIGITS)) {
+        handle.glyphs[length++] = VFD_Layout::fontGlyph(*string++);
+    }
+    handle.length       = length;
+    handle.colon_symbol = colon_symbol;
+    return length;
+}
+
+
+/**
+ * @brief Write a string encoded by VFD_encodeString() and send the modified grids.
+ *      The grid cursor is not modified.
+ * @param handle Encoded string.
+ * @param position Character position of the first character (range 1..VFD_DISPLAYABLE_DIGITS;
+ *      see VFD_Layout::gridPosition() to convert a grid number).
+ *      The characters that don't fit in the displayable digits are discarded;
+ *      nothing is written for position 0.
+ */
+void VFD_writeEncoded(const VFD_EncodedString &handle, uint8_t position)
+{
+    if (position == 0) {
+        // Not a character position
+        return;
+    }
+    for (uint8_t i = 0; (i < handle.length) && (position <= VFD_DISPLAYABLE_DIGITS); i++, position++) {
+        VFD_Layout::writeGlyph<VFD_Driver>(position, handle.glyphs[i], handle.colon_symbol);
+    }
+    VFD_flush();
+}
+
+
+/**
+ * State of the scroller
+ *
+ * The characters of the window are kept encoded (see VFD_Layout::fontGlyph()) in a ring
+ * of the size of the window: at each shift, only the entering character is looked up
+ * in the font; it replaces the leaving one and the start of the ring moves by one slot.
+ * @see VFD_scrollStart(), VFD_scrollTick(), VFD_scrollText()
+ */
+static struct {
+    const char *string;     // Scrolled string
+    uint16_t    size;       // Length of the string
+    uint16_t    left_shift; // Index of the first displayed character
+    uint16_t    next;       // Index of the next character entering the window
+    uint8_t     position;   // Character position of the window
+    uint8_t     width;      // Number of characters of the window
+    uint8_t     head;       // Slot of the ring displayed at the first position
+    bool        marquee;    // Endless scrolling, the string wraps around
+    bool        running;
+    uint32_t    next_ms;    // Time of the next step
+    VFD_Layout::Glyph ring[VFD_DISPLAYABLE_DIGITS]; // Encoded characters of the window
+} scroller;
+
+
+/**
+ * @brief Draw the window from the ring and send the modified grids.
+ */
+static void VFD_scrollDraw(void)
+{
+    uint8_t slot = scroller.head;
+
+    for (uint8_t i = 0; i < scroller.width; i++) {
+        VFD_Layout::writeGlyph<VFD_Driver>(scroller.position + i, scroller.ring[slot], false);
+        if (++slot == scroller.width) {
+            slot = 0;
+        }
+    }
+    VFD_flush();
+
+    // Reset/Update display
+    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
+    // See VFD_busySpinningCircle() (same behavior)
+    VFD_resetDisplay();
 }
 
 
 /**
- * @brief Scroll the given string on the display
+ * @brief Encode the first characters of the string and display them
+ *      from the current grid cursor.
+ */
+static void VFD_scrollBegin(const char *string, bool marquee)
+{
+    const char *string_end = string;
+    while ((*string_end > '\0') && (string_end - string < 0xFFFF)) {
+        string_end++;
+    }
+
+    scroller.string     = string;
+    scroller.size       = string_end - string;
+    scroller.left_shift = 0;
+    scroller.head       = 0;
+    scroller.position   = VFD_Layout::gridPosition(grid_cursor);
+    scroller.width      = (scroller.position <= VFD_DISPLAYABLE_DIGITS)
+                          ? VFD_DISPLAYABLE_DIGITS - scroller.position + 1 : 0;
+    if (!scroller.width) {
+        // Grid cursor out of the displayable characters: nothing to scroll
+        scroller.size = 0;
+    }
+    // Without wrap-around, a short string is just displayed
+    scroller.marquee    = marquee && scroller.size;
+    if (!scroller.marquee && scroller.width > scroller.size) {
+        scroller.width = scroller.size;
+    }
+
+    uint16_t index = 0;
+    for (uint8_t i = 0; i < scroller.width; i++) {
+        scroller.ring[i] = VFD_Layout::fontGlyph(string[index]);
+        if (++index == scroller.size) {
+            index = 0;
+        }
+    }
+    scroller.next = index;
+
+    VFD_scrollDraw();
+}
+
+
+/**
+ * @brief Test if the window can be shifted.
+ */
+static inline bool VFD_scrollHasNext(void)
+{
+    return scroller.marquee || (scroller.left_shift + scroller.width < scroller.size);
+}
+
+
+/**
+ * @brief Shift the window by one character and display it.
+ *      The entering character replaces the leaving one in the ring.
+ */
+static void VFD_scrollShift(void)
+{
+    scroller.ring[scroller.head] = VFD_Layout::fontGlyph(scroller.string[scroller.next]);
+    if (++scroller.next == scroller.size) {
+        scroller.next = 0;
+    }
+    if (++scroller.head == scroller.width) {
+        scroller.head = 0;
+    }
+    if (++scroller.left_shift == scroller.size) {
+        // Marquee: the string starts again
+        scroller.left_shift = 0;
+    }
+    VFD_scrollDraw();
+}
+
+
+/**
+ * @brief Scroll the given string on the display, from the current grid cursor.
  *      The speed can be adjusted by modifying VFD_SCROLL_SPEED define.
- * @param string String to display; must be null terminated '\0'.
+ * @param string String to display; must be null terminated '\0' (up to 65535 characters).
  * @param pfunc (Optional) Callback called at the end of each scrolling iteration.
  *      It avoids blocking the program during the display loop.
  *      Can be used to test keys, set leds, etc.
+ * @see VFD_scrollStart() for a non-blocking version.
  */
 void VFD_scrollText(const char *string, void(pfunc)())
 {
-    // Save the current grid cursor to start the scrolling on the same position at each iteration
-    uint8_t cursor_save = grid_cursor;
-
-    // Find the input string length
-    // Save the addr of the string
-    const char *string_start_pos = string;
-    uint8_t    size = 0;
-
-    while (*string > '\0') {
-        size++;
-        string++;
-    }
-    // Restore the pointer to the input string
-    string = string_start_pos;
-
-    // Split the string into segments of the number of displayable characters,
-    // then shift one letter at each iteration
-    char    string_temp[VFD_DISPLAYABLE_DIGITS + 1] = "";
-    uint8_t left_shift = 0;
-    while ((left_shift + VFD_DISPLAYABLE_DIGITS - 1) < size) {
-        // Copy the segment from original string to a temporary string
-        uint8_t temp_index = 0;
-        for (uint8_t i = left_shift; i < (left_shift + VFD_DISPLAYABLE_DIGITS); i++)
-        {
-            string_temp[temp_index] = string[i];
-            temp_index++;
+    VFD_scrollBegin(string, false);
+    _delay_ms(VFD_SCROLL_START_DELAY);
+
+    while (true) {
+        if (pfunc != nullptr) {
+            pfunc();
+        }
+        if (!VFD_scrollHasNext()) {
+            break;
         }
-        string_temp[temp_index] = '\0';
+        VFD_scrollShift();
+        _delay_ms(VFD_SCROLL_DELAY);
+    }
+    _delay_ms(VFD_SCROLL_END_DELAY);
+}
 
-        // Send the string to the controller
-        VFD_writeString(string_temp, false);
 
-        // Reset/Update display
-        // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-        // See VFD_busySpinningCircle() (same behavior)
-        VFD_resetDisplay();
+/**
+ * @brief Start the non-blocking scrolling of the given string.
+ *      The first characters are displayed immediately; the next steps are made by
+ *      VFD_scrollTick() which must be called from the main loop (or a timer callback).
+ *      The scrolling starts on the current grid cursor.
+ * @param string String to display; must be null terminated '\0' (up to 65535 characters).
+ *      The string is NOT copied: it must stay valid until the end of the scrolling.
+ * @param now_ms Current time in milliseconds (Ex: millis() on Arduino).
+ * @param marquee (Optional) Scroll endlessly: the beginning of the string follows its end
+ *      (add trailing spaces to separate them), until VFD_scrollStop().
+ *      Short strings are also scrolled.
+ * @see VFD_scrollText() for the blocking version.
+ */
+void VFD_scrollStart(const char *string, uint32_t now_ms, bool marquee)
+{
+    scroller.running = false;
+    VFD_scrollBegin(string, marquee);
+    scroller.running = true;
 
-        if (left_shift == 0)
-             _delay_ms(1000);
-        else
-             _delay_ms(VFD_SCROLL_DELAY);
+    // Strings that fit on the display are just displayed
+    scroller.next_ms = now_ms + (VFD_scrollHasNext() ? VFD_SCROLL_START_DELAY : VFD_SCROLL_END_DELAY);
+}
 
-        left_shift++;
 
-        if (pfunc != nullptr) {
-            pfunc();
-        }
+/**
+ * @brief Make the next step of the scrolling started with VFD_scrollStart() if it is due.
+ *      Nothing is sent to the controller if no step is due; so this function can be called
+ *      as often as wanted.
+ *      Delays: VFD_SCROLL_START_DELAY on the first characters, VFD_SCROLL_DELAY between
+ *      each shift, VFD_SCROLL_END_DELAY on the last characters (not in marquee mode).
+ *      Steps are scheduled from the previous due time, thus a late call doesn't shift
+ *      the following ones.
+ *      Each step sends only the grids of the window, from the pre-encoded characters.
+ * @param now_ms Current time in milliseconds, from the same clock as for VFD_scrollStart().
+ *      Overflows of the counter are supported.
+ * @return true while the scrolling is in progress, false when it is over (or not started).
+ */
+bool VFD_scrollTick(uint32_t now_ms)
+{
+    if (!scroller.running) {
+        return false;
+    }
+    if ((int32_t)(now_ms - scroller.next_ms) < 0) {
+        // Nothing to do yet
+        return true;
+    }
+
+    if (!VFD_scrollHasNext()) {
+        // Last characters have been displayed for VFD_SCROLL_END_DELAY
+        scroller.running = false;
+        return false;
+    }
+
+    VFD_scrollShift();
+
+    scroller.next_ms += VFD_scrollHasNext() ? VFD_SCROLL_DELAY : VFD_SCROLL_END_DELAY;
+    return true;
+}
+
+
+/**
+ * @brief Stop the scrolling started with VFD_scrollStart().
+ *      The displayed characters are left as is.
+ */
+void VFD_scrollStop(void)
+{
+    scroller.running = false;
+}
+
+
+/**
+ * @brief Animation for a busy spinning circle.
+ *      The frame is drawn by VFD_busySpinningCircleFrame() (specific to the display variant)
+ *      and sent to the controller.
+ * @param address Memory address (display variant 1) or grid number (display variant 2)
+ *      where the animation frames must be displayed.
+ * @param frame_number Current frame to display (Value range 1..6 (6 segments));
+ *      This value is updated when the frame is modified.
+ *      The frame number goes back to 1 once 6 is exceeded.
+ * @param loop_number Number of refreshes for a frame; used to set the duty cycle of fading frames.
+ *      This value is incremented at each call.
+ * @note
+ *      A same frame is refreshed 70 times before moving to the next.
+ *      An entire loop is made in 420 calls (6 frames * 70 calls each).
+ *      It's up to you to adjust the total time of a loop to 1 second by setting up
+ *      a delay (VFD_BUSY_DELAY) after a call (should be ~2.35ms).
+ * @note The grid_cursor global variable is not modified.
+ * @see VFD_busyWrapper(), VFD_spinnerStart()
+ */
+void VFD_busySpinningCircle(uint8_t address, uint8_t &frame_number, uint8_t &loop_number)
+{
+    VFD_busySpinningCircleFrame(address, frame_number, loop_number);
 
-        // Restore grid cursor
-        // not on last iteration // todo PROPRE
-        if ((left_shift + VFD_DISPLAYABLE_DIGITS - 1) < size) {
-            VFD_setGridCursor(cursor_save, false);
+    loop_number++;
+    if (loop_number == VFD_Layout::SpinnerFrames::loops) {
+        if (frame_number == VFD_Layout::SpinnerFrames::frames) {
+            frame_number = 0;
         }
+        frame_number++;
+        loop_number = 0;
     }
-    _delay_ms(2000);
+
+    // Only the frame is sent if the remaining of the display is unchanged
+    // (text & icons are merged here)
+    VFD_flush();
+
+    // Reset/Update display
+    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
+    VFD_resetDisplay();
 }
 
 
@@ -329,6 +682,7 @@ void VFD_scrollText(const char *string, void(pfunc)())
  * @param pfunc (Optional) Callback called at the end of each frame change.
  *      It avoids blocking the program during the display loop.
  *      Can be used to test keys, set leds, etc.
+ * @note The spinning circle is removed from the display at the end.
  * @see VFD_busySpinningCircle()
  */
 void VFD_busyWrapper(uint8_t address, void(pfunc)())
@@ -348,149 +702,103 @@ void VFD_busyWrapper(uint8_t address, void(pfunc)())
         // Pause between frames
         _delay_ms(VFD_BUSY_DELAY);
     }
+
+    // Remove the last frame: the animations layer is merged with the next texts
+    VFD_Driver::clearAnimations();
+    VFD_Driver::flushLayers();
 }
 
 
+#if ENABLE_TIMER == 1
 /**
- * @brief Set status of LEDs.
- *      Up to 4 LEDs can be controlled.
- * @param leds Byte where the 4 least significant bits are used.
- *      Set a bit to 1 to turn on a LED.
- *      Bit 0: LED 1
- *      ...
- *      Bit 3: LED 4
+ * State of the spinning circle driven by the timer interrupt
+ * @see VFD_spinnerStart()
  */
-void VFD_setLEDs(uint8_t leds)
-{
-    // Enable LED Read mode
-    // Data set cmd, normal mode, auto incr, write data to LED port
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_LED_WR, false);
-
-    // Invert the bits:
-    // 0: LED lights
-    // 1: LED turns off
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        if ((1 << i) & leds) {
-            // Bit is set: Clear the bit
-            leds &= ~(1 << i);
-        }
-    }
+static struct {
+    volatile bool running;
+    uint8_t       address;      // Memory address or grid number (see VFD_busySpinningCircle())
+    uint8_t       frame_number;
+    uint8_t       loop_number;
+} spinner;
 
-    VFD_command(leds & PT6312_LED_MSK, true);
 
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+/**
+ * @brief Start the busy spinning circle in background.
+ *      Frames are updated by the timer interrupt at VFD_TIMER_FREQUENCY
+ *      (420 Hz = 1 loop per second), whatever the load of the main program.
+ * @param address Memory address (display variant 1) or grid number (display variant 2)
+ *      where the animation frames must be displayed. See VFD_busySpinningCircle().
+ * @note A frame is not sent if the interrupt occurs during a transmission of the main
+ *      program; it's drawn in animationBuffer and sent with the next frame or VFD_flush().
+ *      The frames are drawn in their own layer: the text under the animation is kept.
+ * @see VFD_spinnerStop(), VFD_spinnerSetPosition()
+ */
+void VFD_spinnerStart(uint8_t address)
+{
+    spinner.running      = false;
+    spinner.address      = address;
+    spinner.frame_number = 1;
+    spinner.loop_number  = 0;
+    spinner.running      = true;
 }
 
 
 /**
- * @brief Get status of keys
- *      Keys status are stored in the 3 least significant bytes of a uint32_t.
- *      Each of the 4 keys is sampled 6 times.
- *      In a sample, 4 bits for keys: 0, 1, 2, 3 (from least to most significant bit).
- *      If a key is pressed raw_keys is > 0.
- *      Sample Masks:
- *          Sample 0: raw_keys & 0x0F
- *          Sample 1: (raw_keys >> 4) & 0x0F
- *          Sample 2: (raw_keys >> 8) & 0x0F
- *          Sample 3: (raw_keys >> 12) & 0x0F
- *          Sample 4: (raw_keys >> 16) & 0x0F
- *          Sample 5: (raw_keys >> 20) & 0x0F
- * @return 6 samples of 4 bits each in the 3 least significant bytes of a uint32_t
+ * @brief Stop the busy spinning circle started with VFD_spinnerStart().
+ *      The segments of the animation are turned off, the text under it is restored.
  */
-uint32_t VFD_getKeys(void)
+void VFD_spinnerStop(void)
 {
-    // Enable Key Read mode
-    // Data set cmd, normal mode, auto incr, read data
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_KEY_RD, false);
-
-    // Configure DATA pin input HIGH
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _INPUT);
-    _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
-
-    // Here: CS is still LOW, SCLK is still HIGH
-    _delay_us(1);
-
-    // Read the key matrix of size PT6312_KEY_MEM bytes
-    // 3 bytes = 3 readings
-    uint32_t raw_keys = PT6312_KEY_MSK & VFD_readByte();
-    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & VFD_readByte());
-    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & VFD_readByte());
+    spinner.running = false;
 
-    // Restore DATA pin as OUTPUT
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
-
-    VFD_CSSignal();
-
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
-
-    return raw_keys;
+    VFD_Driver::clearAnimations();
+    VFD_Driver::flushLayers();
 }
 
 
 /**
- * @brief Get the number of the first pressed button (no multi buttons)
- *      Button 0: 1
- *      ...
- *      Button 3: 4
- * @see VFD_getKeys()
- * @return The number of the first pressed button or 0 if no button is pressed.
+ * @brief Move the busy spinning circle started with VFD_spinnerStart().
+ *      The animation continues from its current frame.
+ * @param address Memory address (display variant 1) or grid number (display variant 2)
+ *      where the animation frames must be displayed. See VFD_busySpinningCircle().
  */
-uint8_t VFD_getKeyPressed(void)
+void VFD_spinnerSetPosition(uint8_t address)
 {
-    uint8_t btn_nr = 1, pressed_btn = 0;
-
-    // Get 1 sample (6th sample): Last 4 bits of the uint32_t
-    pressed_btn = PT6312_KEY_SMPL_MSK & PT6312_KEY_MSK & VFD_getKeys();
-    if (pressed_btn > 0) {
-        // Return the button number
-        while (((1 << btn_nr) & pressed_btn) == 0) {
-            btn_nr++;
-        }
-        return btn_nr;
-    }
-    return 0;
+    bool running = spinner.running;
+    VFD_spinnerStop();
+    spinner.address = address;
+    spinner.running = running;
 }
 
 
 /**
- * @brief Get status of switches
- *      Switches status are stored in the last 4 bits of the returned byte.
- *      The first (lowest) bit represents switch 0.
- *      Ex: 0b....0001
- *                   |
- *                   switch 0 is pressed
+ * @brief Draw and send the next frame of the busy spinning circle.
+ *      Called by the timer interrupt.
+ *      The frame is not sent if the bus is in use by the main program.
  */
-uint8_t VFD_getSwitches(void)
+void VFD_spinnerInterrupt(void)
 {
-    // Enable Switch Read mode
-    // Data set cmd, normal mode, auto incr, read data
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_SW_RD, false);
-
-    // Make DATA pin input HIGH
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _INPUT);
-    _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
-
-    // Here: CS is still LOW, SCLK is still HIGH
-    _delay_us(1);
-
-    uint8_t raw_switches = PT6312_SW_MSK & VFD_readByte();
-
-    // DATA pin as OUTPUT
-    _pinMode(VFD_DATA_DDR, VFD_DATA_PIN, _OUTPUT);
+    if (!spinner.running) {
+        return;
+    }
 
-    VFD_CSSignal();
+    uint8_t address = VFD_busySpinningCircleFrame(spinner.address, spinner.frame_number, spinner.loop_number);
 
-    // Restore Data Write mode
-    // Data set cmd, normal mode, auto incr, write data to memory
-    VFD_command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR, true);
+    spinner.loop_number++;
+    if (spinner.loop_number == VFD_Layout::SpinnerFrames::loops) {
+        if (spinner.frame_number == VFD_Layout::SpinnerFrames::frames) {
+            spinner.frame_number = 0;
+        }
+        spinner.frame_number++;
+        spinner.loop_number = 0;
+    }
 
-    return raw_switches;
+    // Not sent if a transmission is in progress
+    if (VFD_busIdle()) {
+        VFD_Driver::flushRange(address, VFD_Layout::spinnerBytes);
+    }
 }
+#endif
 
 
 /**
@@ -516,7 +824,8 @@ void VFD_segmentsGenericTest(void)
 
     for (uint8_t grid = 1; grid <= VFD_GRIDS; grid++)
     {
-        // Note: VFD_SEGMENTS is defined in VFD_resetDisplay()
+        uint8_t memory_addr = (grid * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+
         for (uint8_t i = 0; i < VFD_SEGMENTS; i++)
         {
             if (i < 8) {
@@ -527,11 +836,10 @@ void VFD_segmentsGenericTest(void)
                 lsb = 0;
             }
 
-            // Set grid
-            VFD_setGridCursor(grid, false);
-            // Set segments
-            VFD_command(lsb, false);
-            VFD_command(msb, true);
+            // Set segments of the grid
+            displayBuffer[memory_addr]     = lsb;
+            displayBuffer[memory_addr + 1] = msb;
+            VFD_flush();
 
             _delay_ms(2000);
         }
@@ -540,43 +848,19 @@ void VFD_segmentsGenericTest(void)
 }
 
 
-/**
- * @brief Test the display of all segments of the display.
- *      It's the opposite of VFD_clear().
- */
-void VFD_displayAllSegments(void)
-{
-    VFD_setGridCursor(1, false);
-    for (uint8_t grid = 1; grid <= VFD_GRIDS; grid++)
-    {
-        // Display a segment
-        VFD_command(255, false);
-        VFD_command(255, false);
-    }
-    VFD_CSSignal();
-
-    grid_cursor = VFD_GRIDS;
-
-    // Reset/Update display
-    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
-    // See VFD_busySpinningCircle() (same behavior)
-    VFD_resetDisplay();
-}
-
-
 /**
  * @brief Display and scroll all available characters in the current font
  */
 void VFD_displayAllFontGlyphes(void)
 {
     uint8_t       i, j = 0;
-    const uint8_t arrayLength             = ((sizeof(FONT) / sizeof(uint8_t)) / 2);
+    const uint8_t arrayLength             = VFD_Layout::fontSize;
     char          string[arrayLength + 1] = "";
 
     for (i = 0; i < arrayLength; i++)
     {
         // Do not display N/A chars
-        if ((FONT[i][0] | FONT[i][1]) > 0) {
+        if ((VFD_Layout::fontMSB(i + 0x20) | VFD_Layout::fontLSB(i + 0x20)) > 0) {
             string[j] = i + 0x20;
             j++;
         }
@@ -585,177 +869,71 @@ void VFD_displayAllFontGlyphes(void)
 }
 
 
+#if (VFD_TRANSPORT == VFD_TRANSPORT_USI) || (VFD_TRANSPORT == VFD_TRANSPORT_SPI)
 /**
- * @brief Send a byte in a write command to the controller
- * @param value Byte to send.
- * @param cmd (Optional)
- *      If True, the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after the byte has been sent.
- *      Default: false
- */
-void VFD_command(uint8_t value, bool cmd)
-{
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _LOW);
-    _delay_us(1); // NOTE: not in datasheet
-
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _LOW);
-
-        if (value & (1 << i)) {
-            _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _HIGH);
-        }else{
-            _digitalWrite(VFD_DATA_PORT, VFD_DATA_PIN, _LOW);
-        }
-        // wait 500ns
-        _delay_us(0.5);
-        // Data is read at the rising edge
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
-        _delay_us(0.5);
-    }
-
-    if (cmd) {
-        VFD_CSSignal();
-    }
-}
-
-
-/**
- * @brief Signal the driver that the data transmission is over
- *      The CS/Strobe line is asserted to HIGH (end of transmission).
- */
-extern inline void VFD_CSSignal();
-
-
-/**
- * @brief Obtain a byte from the controller (i.e get keys & switches status)
- * @see VFD_getSwitches(), VFD_getKeys(), VFD_getKeyPressed().
- * @return Byte of data
- */
-uint8_t VFD_readByte(void)
-{
-    uint8_t data_in = 0xFF;
-
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _LOW);
-        _delay_us(0.5);
-
-        // Data is read at the falling edge
-        // DigitalRead (read only) of VFD_DATA_PIN status
-        if (bit_is_set(VFD_DATA_R_ONLY_PORT, VFD_DATA_PIN) == 0) {
-            // Bit is not set: Clear the bit
-            data_in &= ~(1 << i);
-        }
-
-        _digitalWrite(VFD_SCLK_PORT, VFD_SCLK_PIN, _HIGH);
-        _delay_us(0.5);
-    }
-    return data_in;
-}
-
-
-/**
- * @brief Write a specific byte at the given address in the controller memory.
- *      This function doesn't use VFD_setGridCursor() to map the position
- *      to a grid.
- * @warning Note that the CS/Strobe line is asserted to HIGH (end of transmission)
- *      after the byte has been sent.
- * @param address Value range 0x00..0x15 (22 addresses).
- * @param data Byte to write at the given address.
- * @warning Since a specific address is used, the grid_cursor global variable IS NOT updated,
- *      and is thus more synchronized with the controller memory.
- *      You SHOULD NOT rely on this value after using this function and use
- *      VFD_setCursorPosition().
- */
-void VFD_writeByte(uint8_t address, char data)
-{
-    VFD_command(PT6312_ADDR_SET_CMD | (address & PT6312_ADDR_MSK), false);
-    VFD_command(data, true);
-}
-
-
-#if ENABLE_ICON_BUFFER == 1
-char iconDisplayBuffer[PT6312_MAX_NR_GRIDS * PT6312_BYTES_PER_GRID] = {0};
-
-/**
- * @brief Add an icon to the buffer.
- *      The icon will be displayed on the next call to VFD_writeString(), VFD_writeInt()
- *      or VFD_busySpinningCircle();
- * @param icon_font_index Index of the icon in the ICONS_FONT array.
- *      Defines can be used.
- */
-void VFD_setIcon(uint8_t icon_font_index)
-{
-    // Get memory address from grid
-    // Grid obtained starts from 0
-    // Ex: for grid=1: (1+1)*2-2 = 2
-    uint8_t addr    = convertGridToMemoryAddress(ICONS_FONT[icon_font_index] & 0x0F);
-    uint8_t segment = ICONS_FONT[icon_font_index] >> 4;
-
-    // Address in iconDisplayBuffer is depends on the localization of the segment
-    // (LSB or MSB)
-    if (segment < 8) {
-        // LSB
-        iconDisplayBuffer[addr] |= 1 << segment;
-    } else { // > 7
-        // MSB
-        iconDisplayBuffer[addr + 1] |= 1 << (segment - 8);
-    }
-}
-
-
-/**
- * @brief Remove an icon from the buffer.
- *      The icon will be removed on the next call to VFD_writeString(), VFD_writeInt()
- *      or VFD_busySpinningCircle();
- * @param icon_font_index Index of the icon in the ICONS_FONT array.
- *      Defines can be used.
+ * @brief Configure the hardware peripheral used to talk to the controller.
+ *      SCLK idles HIGH, data is changed on falling edges and latched on rising
+ *      edges (SPI mode 3), bits are sent from the least significant one.
+ * @see VFD_TRANSPORT in global.h
  */
-void VFD_clearIcon(uint8_t icon_font_index)
+void VFD_transportInitialize(void)
 {
-    // Get memory address from grid
-    // Grid obtained starts from 0
-    // Ex: for grid=1: (1+1)*2-2 = 2
-    uint8_t addr    = convertGridToMemoryAddress(ICONS_FONT[icon_font_index] & 0x0F);
-    uint8_t segment = ICONS_FONT[icon_font_index] >> 4;
-
-    // Address in iconDisplayBuffer is depends on the localization of the segment
-    // (LSB or MSB)
-    if (segment < 8) {
-        // LSB
-        iconDisplayBuffer[addr] |= ~(1 << segment);
-    } else { // > 7
-        // MSB
-        iconDisplayBuffer[addr + 1] |= ~(1 << (segment - 8));
-    }
+    // DATA IN is wired to the DATA line: never drive it
+    _pinMode(VFD_DATA_IN_DDR, VFD_DATA_IN_PIN, _INPUT);
+
+    #if VFD_TRANSPORT == VFD_TRANSPORT_USI
+    // Three-wire mode, software clock strobe (USITC).
+    // USCK idles HIGH (set in VFD_initialize()): DO is updated on the falling
+    // edges and the controller latches it on the rising edges.
+    USICR = (1 << USIWM0);
+    #elif VFD_TRANSPORT == VFD_TRANSPORT_SPI
+    _pinMode(VFD_SPI_SS_DDR, VFD_SPI_SS_PIN, _OUTPUT);
+    // Master, LSB first, mode 3, SCLK <= 1MHz
+    SPCR = (1 << SPE) | (1 << MSTR) | (1 << DORD) | (1 << CPOL) | (1 << CPHA) | VFD_SPI_CLOCK_BITS;
+    SPSR = VFD_SPI_2X << SPI2X;
+    #endif
 }
 
 
+#if VFD_TRANSPORT == VFD_TRANSPORT_USI
 /**
- * @brief Clear the icon buffer.
- *      All the icons will be removed on the next call to VFD_writeString(), VFD_writeInt()
- *      or VFD_busySpinningCircle();
+ * @brief Mirror the bits of a byte.
+ *      The USI only shifts the most significant bit first while the controller
+ *      expects the least significant bit first.
  */
-void VFD_clearIcons()
+static inline uint8_t VFD_reverseBits(uint8_t value)
 {
-    for (uint8_t i = 0; i < (PT6312_MAX_NR_GRIDS * PT6312_BYTES_PER_GRID); i++)
-    {
-        iconDisplayBuffer[i] = 0;
-    }
+    value = (value >> 4) | (value << 4);
+    value = ((value & 0xCC) >> 2) | ((value & 0x33) << 2);
+    value = ((value & 0xAA) >> 1) | ((value & 0x55) << 1);
+    return value;
 }
+#endif
 
 
 /**
- * @brief Convert grid number to a memory address
- * @param grid Grid number (starting from 0)
- * @return Address of the memory cell in the icon buffer
- *      (or in the memory of the controller).
+ * @brief Exchange a byte with the controller through the hardware peripheral.
+ *      The CS/Strobe line is not handled here.
+ * @param value Byte to send; 0xFF when reading (DATA pin must be an input).
+ * @return Byte sampled on the DATA IN pin.
  */
-inline uint8_t convertGridToMemoryAddress(uint8_t grid)
+uint8_t VFD_transferByte(uint8_t value)
 {
-    return ((grid + 1) * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    #if VFD_TRANSPORT == VFD_TRANSPORT_USI
+    USIDR = VFD_reverseBits(value);
+    // Clear the overflow flag and the 4 bits counter (16 edges = 8 bits)
+    USISR = (1 << USIOIF);
+    do {
+        USICR = (1 << USIWM0) | (1 << USICS1) | (1 << USICLK) | (1 << USITC);
+        #if VFD_USI_PAD_CYCLES > 5
+        __builtin_avr_delay_cycles(VFD_USI_PAD_CYCLES - 5);
+        #endif
+    } while ((USISR & (1 << USIOIF)) == 0);
+    return VFD_reverseBits(USIDR);
+    #elif VFD_TRANSPORT == VFD_TRANSPORT_SPI
+    SPDR = value;
+    loop_until_bit_is_set(SPSR, SPIF);
+    return SPDR;
+    #endif
 }
-
-
 #endif
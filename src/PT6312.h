@@ -21,8 +21,7 @@
 #ifndef ET16312N_H
 #define ET16312N_H
 
-#include <avr/io.h>
-#include <util/delay.h>
+#include "hal.h"
 #include <global.h>
 
 
@@ -37,6 +36,24 @@
 #define _pinMode(DDR, PIN, MODE)        (DDR MODE (1 << PIN))
 #define _digitalWrite(PORT, PIN, MODE)  (PORT MODE (1 << PIN))
 
+/**
+ * Transports (see VFD_TRANSPORT in global.h)
+ */
+#define VFD_TRANSPORT_BITBANG    0 // Software, any pins
+#define VFD_TRANSPORT_USI        1 // ATtiny USI in three-wire mode
+#define VFD_TRANSPORT_SPI        2 // ATmega SPI in LSB first mode
+#define VFD_TRANSPORT_LINUX      3 // Linux backend: whole transactions (see linux/linux_hal.h)
+
+#if defined(VFD_HOST) && (VFD_TRANSPORT != VFD_TRANSPORT_BITBANG)
+    #error "The host backend only simulates VFD_TRANSPORT_BITBANG!"
+#endif
+#if defined(VFD_LINUX) && (VFD_TRANSPORT != VFD_TRANSPORT_BITBANG) && (VFD_TRANSPORT != VFD_TRANSPORT_LINUX)
+    #error "The Linux backend supports VFD_TRANSPORT_BITBANG and VFD_TRANSPORT_LINUX only!"
+#endif
+#if !defined(VFD_LINUX) && (VFD_TRANSPORT == VFD_TRANSPORT_LINUX)
+    #error "VFD_TRANSPORT_LINUX requires the Linux backend (VFD_LINUX)!"
+#endif
+
 /**
  * Driver constants
  */
@@ -65,6 +82,35 @@
 #define PT6312_GR10_SEG12        0x06
 #define PT6312_GR11_SEG11        0x07
 
+// Display mode & number of segments for the configured number of grids
+#if VFD_GRIDS == 4
+    #define VFD_DISPLAY_MODE     PT6312_GR4_SEG16
+    #define VFD_SEGMENTS         16
+#elif VFD_GRIDS == 5
+    #define VFD_DISPLAY_MODE     PT6312_GR5_SEG16
+    #define VFD_SEGMENTS         16
+#elif VFD_GRIDS == 6
+    #define VFD_DISPLAY_MODE     PT6312_GR6_SEG16
+    #define VFD_SEGMENTS         16
+#elif VFD_GRIDS == 7
+    #define VFD_DISPLAY_MODE     PT6312_GR7_SEG15
+    #define VFD_SEGMENTS         15
+#elif VFD_GRIDS == 8
+    #define VFD_DISPLAY_MODE     PT6312_GR8_SEG14
+    #define VFD_SEGMENTS         14
+#elif VFD_GRIDS == 9
+    #define VFD_DISPLAY_MODE     PT6312_GR9_SEG13
+    #define VFD_SEGMENTS         13
+#elif VFD_GRIDS == 10
+    #define VFD_DISPLAY_MODE     PT6312_GR10_SEG12
+    #define VFD_SEGMENTS         12
+#elif VFD_GRIDS == 11
+    #define VFD_DISPLAY_MODE     PT6312_GR11_SEG11
+    #define VFD_SEGMENTS         11
+#else
+    #error "VFD_GRIDS must be in range 4..11!"
+#endif
+
 // Data setting commands
 #define PT6312_DATA_SET_CMD      0x40
 #define PT6312_DATA_WR           0x00
@@ -141,62 +187,228 @@
     }
 
 /**
- * Global variables
+ * Bus arbitration & hardware transports (used by the driver)
+ */
+// Set while a sequence of commands must not be interrupted by the timer interrupt
+// (Ex: data setting command changed for a read)
+extern volatile bool vfd_bus_locked;
+// Only available if VFD_TRANSPORT is the USI or SPI transport
+void VFD_transportInitialize(void);
+uint8_t VFD_transferByte(uint8_t value);
+
+// Steps of a transmission (see PT6312::txSend())
+#define VFD_TX_START    0x01 // CS/Strobe line LOW (start of transmission)
+#define VFD_TX_DATA     0x02 // Byte sent
+#define VFD_TX_END      0x04 // CS/Strobe line HIGH (end of transmission)
+// Max number of controllers using the transmit queue
+#define VFD_TX_SENDERS  4
+typedef void (*VFD_TxSender)(uint8_t value, uint8_t flags);
+#if VFD_TX_QUEUE_SIZE > 0
+// Set while the transmissions bypass the queue (reads, timer interrupt)
+extern volatile bool vfd_tx_direct;
+uint8_t VFD_txRegister(VFD_TxSender sender);
+void VFD_txPush(uint8_t value, uint8_t flags);
+bool VFD_txEmpty(void);
+void VFD_txFence(void);
+void VFD_txInterrupt(void);
+#endif
+
+/**
+ * Instrumentation (see stats.cpp)
+ */
+#if VFD_STATS == 1
+// Counters of the bus operations since the start of the program or VFD_statsReset()
+struct VFD_Stats
+{
+    uint32_t commands;          // Calls of VFD_command()
+    uint32_t bytesSent;         // Bytes sent on the bus
+    uint32_t csStrobes;         // Ends of transmission (CS/Strobe line HIGH)
+    uint32_t readTransactions;  // Key/switch reads
+    uint32_t readBytes;         // Bytes read
+    uint32_t modeSwitches;      // Data setting commands sent (write/read mode changes)
+    uint32_t commandCycles;     // CPU cycles spent in VFD_command()
+    uint32_t readCycles;        // CPU cycles spent in VFD_readByte()
+};
+extern VFD_Stats VFD_stats;
+void VFD_statsReset(void);
+// Clock of the cycle counters (weak: can be replaced by the program)
+uint32_t VFD_statsCycles(void);
+#if ENABLE_TIMER == 1 && !defined(VFD_HOST) && !defined(VFD_LINUX)
+uint32_t VFD_timerCycles(void);
+#endif
+#endif
+#if VFD_TRACE_HOOKS == 1
+// Called before the CS/Strobe line goes LOW and after it goes HIGH (weak: empty by default)
+void VFD_transactionBegin(void);
+void VFD_transactionEnd(void);
+#endif
+
+#include "pins.h"
+#include "PT6312_driver.h"
+#include "PT6312_bus.h"
+
+// Select font & functions according to global.h setting
+#if defined(VFD_VARIANT_1)
+    #include "display_variants/variant_1_functions.h"
+    typedef VFD_Variant1::Layout VFD_Layout;
+#elif defined(VFD_VARIANT_2)
+    #include "display_variants/variant_2_functions.h"
+    typedef VFD_Variant2::Layout VFD_Layout;
+#else
+    #error "Display variant not implemented!"
+#endif
+
+/**
+ * Default driver, configured in global.h; used by all the VFD_* functions
+ */
+#ifdef VFD_LINUX
+VFD_DEFINE_LINE_PIN(VFD_CsPin, VFD_CS_LINE);
+VFD_DEFINE_LINE_PIN(VFD_SclkPin, VFD_SCLK_LINE);
+VFD_DEFINE_LINE_PIN(VFD_DataPin, VFD_DATA_LINE);
+#else
+// The input register of CS & SCLK pins is never read
+VFD_DEFINE_PIN(VFD_CsPin, VFD_CS_DDR, VFD_CS_PORT, VFD_CS_PORT, VFD_CS_PIN);
+VFD_DEFINE_PIN(VFD_SclkPin, VFD_SCLK_DDR, VFD_SCLK_PORT, VFD_SCLK_PORT, VFD_SCLK_PIN);
+VFD_DEFINE_PIN(VFD_DataPin, VFD_DATA_DDR, VFD_DATA_PORT, VFD_DATA_R_ONLY_PORT, VFD_DATA_PIN);
+#endif
+
+typedef PT6312<VFD_CsPin, VFD_SclkPin, VFD_DataPin, VFD_GRIDS, VFD_Layout, VFD_TRANSPORT> VFD_Driver;
+
+/**
+ * Global variables (members of the default driver)
  */
 // Grid cursor (starting from 1)
-extern uint8_t grid_cursor;
+static constexpr uint8_t &grid_cursor = VFD_Driver::gridCursor;
+// Text layer of the display, written by all drawing functions, merged with the icons
+// and animations layers and sent with VFD_flush()
+static constexpr uint8_t (&displayBuffer)[PT6312_DISPLAY_MEM] = VFD_Driver::displayBuffer;
+// Animations layer (busy spinning circle), merged with displayBuffer on VFD_flush()
+static constexpr uint8_t (&animationBuffer)[PT6312_DISPLAY_MEM] = VFD_Driver::animationBuffer;
+
+/**
+ * String encoded for the layout of the default driver
+ * @see VFD_encodeString(), VFD_writeEncoded()
+ */
+struct VFD_EncodedString
+{
+    uint8_t           length;
+    bool              colon_symbol;
+    VFD_Layout::Glyph glyphs[VFD_DISPLAYABLE_DIGITS];
+};
 
 /**
  * Generic API
  */
 void VFD_initialize(void);
-void VFD_resetDisplay(void);
-void VFD_setBrightness(const uint8_t brightness);
-void VFD_clear(void);
+void VFD_initializeStart(uint32_t now_ms);
+bool VFD_initializeTick(uint32_t now_ms);
+inline void VFD_resetDisplay(void) { VFD_Driver::resetDisplay(); }
+inline void VFD_setBrightness(const uint8_t brightness) { VFD_Driver::setBrightness(brightness); }
+inline void VFD_clear(void) { VFD_Driver::clear(); }
+inline void VFD_flush(void) { VFD_Driver::flush(); }
+inline void VFD_flushLayers(void) { VFD_Driver::flushLayers(); }
+inline void VFD_clearAnimations(void) { VFD_Driver::clearAnimations(); }
+inline void VFD_invalidate(void) { VFD_Driver::invalidate(); }
 
 /**
  * Display functions
  */
-void VFD_setGridCursor(uint8_t position, bool cmd=false);
-void VFD_writeString(const char *string, bool colon_symbol); // Adapted if ENABLE_ICON_BUFFER is set
+// cmd: Unused, kept for compatibility: the addresses are transmitted by VFD_flush()
+inline void VFD_setGridCursor(uint8_t position, bool cmd=false) { (void)cmd; VFD_Driver::setGridCursor(position); }
+inline void VFD_writeString(const char *string, bool colon_symbol) { VFD_Driver::writeString(string, colon_symbol); }
 void VFD_writeInt(int32_t number, int8_t digits_number, bool colon_symbol);
-void VFD_busySpinningCircle(uint8_t address, uint8_t &frame_number, uint8_t &loop_number); // Adapted if ENABLE_ICON_BUFFER is set
+void VFD_writeFixed(int32_t value, uint8_t frac_digits, int8_t digits_number, bool colon_symbol);
+void VFD_writeHex(uint32_t value, int8_t digits_number, bool colon_symbol);
+uint8_t VFD_encodeString(const char *string, bool colon_symbol, VFD_EncodedString &handle);
+void VFD_writeEncoded(const VFD_EncodedString &handle, uint8_t position);
+void VFD_busySpinningCircle(uint8_t address, uint8_t &frame_number, uint8_t &loop_number);
+// Display variant specific
+inline uint8_t VFD_busySpinningCircleFrame(uint8_t address, uint8_t frame_number, uint8_t loop_number) {
+    return VFD_Driver::busySpinningCircleFrame(address, frame_number, loop_number);
+}
 void VFD_busyWrapper(uint8_t address, void (pfunc)()=nullptr);
 void VFD_scrollText(const char *string, void (pfunc)()=nullptr);
+void VFD_scrollStart(const char *string, uint32_t now_ms, bool marquee=false);
+bool VFD_scrollTick(uint32_t now_ms);
+void VFD_scrollStop(void);
+
+void VFD_clockStart(const char *format, uint8_t position, bool blink_colon);
+void VFD_clockStop(void);
+void VFD_clockSet(uint8_t hours, uint8_t minutes, uint8_t seconds);
+void VFD_clockGet(uint8_t &hours, uint8_t &minutes, uint8_t &seconds);
+void VFD_clockTick(void);
+
+#if ENABLE_TIMER == 1
+void VFD_spinnerStart(uint8_t address);
+void VFD_spinnerStop(void);
+void VFD_spinnerSetPosition(uint8_t address);
+void VFD_spinnerInterrupt(void);
+void VFD_timerStart(void);
+// Tested by the background features before using the bus (weak: can be replaced by the program)
+bool VFD_busIdle(void);
+
+// Brightness levels of the fade engine: VFD_FADE_STEPS levels per brightness setting
+#define VFD_BRIGHTNESS_LEVEL(brightness)    ((brightness) * VFD_FADE_STEPS)
+#define VFD_BRIGHTNESS_LEVEL_MAX            VFD_BRIGHTNESS_LEVEL(PT6312_BRT7)
+
+void VFD_fadeTo(uint8_t level, uint16_t duration_ms);
+void VFD_setBrightnessLevel(uint8_t level);
+bool VFD_fadeRunning(void);
+void VFD_fadeStop(void);
+void VFD_fadeInterrupt(void);
+#endif
+
+#if VFD_CLOCK_TIMER == 1
+void VFD_clockInterrupt(uint32_t period);
+#endif
+
+#if ENABLE_KEY_SCANNER == 1
+// Key events: type in the 2 most significant bits, key number (1..24) in the others
+#define VFD_KEY_EVENT_PRESS      0x00
+#define VFD_KEY_EVENT_RELEASE    0x40
+#define VFD_KEY_EVENT_LONG       0x80
+#define VFD_KEY_EVENT_REPEAT     0xC0
+#define VFD_KEY_EVENT_TYPE(event)   ((event) & 0xC0)
+#define VFD_KEY_EVENT_KEY(event)    ((event) & 0x3F)
+
+void VFD_keyScannerStart(void);
+void VFD_keyScannerStop(void);
+bool VFD_readKeyEvent(uint8_t &event);
+void VFD_keyScannerInterrupt(void);
+#endif
 
 #if ENABLE_ICON_BUFFER == 1
-extern char iconDisplayBuffer[PT6312_MAX_NR_GRIDS * PT6312_BYTES_PER_GRID];
-void VFD_setIcon(uint8_t icon_font_index);
-void VFD_clearIcon(uint8_t icon_font_index);
-void VFD_clearIcons();
-inline uint8_t convertGridToMemoryAddress(uint8_t grid);
+static constexpr uint8_t (&iconDisplayBuffer)[PT6312_DISPLAY_MEM] = VFD_Driver::iconBuffer;
+inline void VFD_setIcon(uint8_t icon_font_index) { VFD_Driver::setIcon(icon_font_index); }
+inline void VFD_clearIcon(uint8_t icon_font_index) { VFD_Driver::clearIcon(icon_font_index); }
+inline void VFD_clearIcons() { VFD_Driver::clearIcons(); }
+inline uint8_t convertGridToMemoryAddress(uint8_t grid) { return grid * PT6312_BYTES_PER_GRID; }
 #endif
 
 /**
  * Keys, switches and LEDs
  */
-void VFD_setLEDs(uint8_t leds);
-uint32_t VFD_getKeys(void);
-uint8_t VFD_getKeyPressed(void);
-uint8_t VFD_getSwitches(void);
+inline void VFD_setLEDs(uint8_t leds) { VFD_Driver::setLEDs(leds); }
+inline uint32_t VFD_getKeys(void) { return VFD_Driver::getKeys(); }
+inline uint8_t VFD_getKeyPressed(void) { return VFD_Driver::getKeyPressed(); }
+inline uint8_t VFD_getSwitches(void) { return VFD_Driver::getSwitches(); }
 
 /**
  * Test functions
  */
 void VFD_segmentsGenericTest(void);
-void VFD_displayAllSegments(void);
+inline void VFD_displayAllSegments(void) { VFD_Driver::displayAllSegments(); }
 void VFD_displayAllFontGlyphes(void);
 
 /**
  * Low level API
  */
-void VFD_command(uint8_t value, bool cmd=false);
-inline void VFD_CSSignal(){
-    _delay_us(1);
-    _digitalWrite(VFD_CS_PORT, VFD_CS_PIN, _HIGH);
-    _delay_us(1);
+inline void VFD_command(uint8_t value, bool cmd=false) { VFD_Driver::command(value, cmd); }
+inline void VFD_CSSignal() { VFD_Driver::CSSignal(); }
+inline uint8_t VFD_readByte(void) { return VFD_Driver::readByte(); }
+inline void VFD_writeByte(uint8_t address, char data) { VFD_Driver::writeByte(address, data); }
+inline void VFD_writeBlock(uint8_t address, const uint8_t *data, uint8_t length) {
+    VFD_Driver::writeBlock(address, data, length);
 }
-uint8_t VFD_readByte(void);
-void VFD_writeByte(uint8_t address, char data);
 
 #endif
@@ -0,0 +1,216 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Several PT6312 controllers sharing the SCLK/DATA lines, each one with its own CS line.
+ * This file is included by PT6312.h.
+ */
+#ifndef PT6312_BUS_H
+#define PT6312_BUS_H
+
+/**
+ * Compile time helpers (no STL on AVR).
+ */
+template<class A, class B> struct VFD_IsSame
+{
+    static constexpr bool value = false;
+};
+
+template<class A> struct VFD_IsSame<A, A>
+{
+    static constexpr bool value = true;
+};
+
+template<bool... Values> struct VFD_All
+{
+    static constexpr bool value = true;
+};
+
+template<bool Value, bool... Values> struct VFD_All<Value, Values...>
+{
+    static constexpr bool value = Value && VFD_All<Values...>::value;
+};
+
+// True if all the drivers have different CS pins
+template<class... Drivers> struct VFD_DistinctCs
+{
+    static constexpr bool value = true;
+};
+
+template<class Driver, class... Others> struct VFD_DistinctCs<Driver, Others...>
+{
+    static constexpr bool value =
+        VFD_All<!VFD_IsSame<typename Driver::Cs, typename Others::Cs>::value...>::value
+        && VFD_DistinctCs<Others...>::value;
+};
+
+
+/**
+ * @return True if the CS/Strobe lines of all the drivers are HIGH.
+ */
+static inline bool VFD_csLinesHigh(void)
+{
+    return true;
+}
+
+template<class Driver, class... Others>
+static inline bool VFD_csLinesHigh(Driver *, Others *... others)
+{
+    return Driver::Cs::isHigh() && VFD_csLinesHigh(others...);
+}
+
+
+/**
+ * Controllers sharing the SCLK/DATA lines of the MCU.
+ *
+ * Every controller keeps its own grids/segments mode, display layout and buffers
+ * (see PT6312); the bus only drives them together.
+ *
+ * @tparam First, Others PT6312 drivers with the same SCLK/DATA pins and transport,
+ *      and different CS pins.
+ *
+ * Ex:
+ *      VFD_DEFINE_PORT_PIN(CsPin2, B, 3);
+ *      VFD_DEFINE_PORT_PIN(CsPin3, B, 4);
+ *      typedef PT6312<CsPin2, VFD_SclkPin, VFD_DataPin, 5, VFD_Variant2::Layout> Display2;
+ *      typedef PT6312<CsPin3, VFD_SclkPin, VFD_DataPin, 4, VFD_Layout> Display3;
+ *      typedef VFD_Bus<VFD_Driver, Display2, Display3> Displays;
+ *
+ *      Displays::initialize();
+ *      Displays::holdAll();
+ *      Display2::setGridCursor(1);
+ *      Display2::writeString("HELLO", false); // Display buffer only
+ *      ...
+ *      Displays::flushAll();
+ */
+template<class First, class... Others>
+class VFD_Bus
+{
+    static_assert(VFD_All<VFD_IsSame<typename First::Sclk, typename Others::Sclk>::value...>::value,
+                  "Controllers of a bus must share the SCLK pin");
+    static_assert(VFD_All<VFD_IsSame<typename First::Data, typename Others::Data>::value...>::value,
+                  "Controllers of a bus must share the DATA pin");
+    static_assert(VFD_All<(First::transport == Others::transport)...>::value,
+                  "Controllers of a bus must use the same transport");
+    static_assert(VFD_DistinctCs<First, Others...>::value,
+                  "Each controller of a bus must have its own CS pin");
+
+public:
+    // Number of controllers
+    static constexpr uint8_t controllers = 1 + sizeof...(Others);
+
+    /**
+     * @brief Configure the pins of the MCU and all the controllers.
+     *      All the CS/Strobe lines are HIGH before the first command is sent,
+     *      and the controllers share the same startup delay (VFD_POWER_UP_DELAY,
+     *      less if VFD_POWER_UP_PROBE is set and all the controllers answer before).
+     */
+    static void initialize(void)
+    {
+        First::configurePins();
+        int pins[] = {0, (Others::configurePins(), 0)...};
+        (void)pins;
+
+        // Waiting for the VFD drivers to startup
+        #if VFD_POWER_UP_PROBE == 1
+        for (uint16_t elapsed_ms = 0; elapsed_ms < VFD_POWER_UP_DELAY && !allResponding(); elapsed_ms++) {
+            _delay_ms(1);
+        }
+        #else
+        _delay_ms(VFD_POWER_UP_DELAY);
+        #endif
+
+        First::configureController();
+        int configurations[] = {0, (Others::configureController(), 0)...};
+        (void)configurations;
+    }
+
+    /**
+     * @brief Test if all the controllers are started.
+     * @see PT6312::isResponding()
+     */
+    static bool allResponding(void)
+    {
+        bool responding = First::isResponding();
+        int probes[] = {0, (responding = Others::isResponding() && responding, 0)...};
+        (void)probes;
+        return responding;
+    }
+
+    /**
+     * @brief Hold the refresh of all the controllers: the drawing functions only
+     *      update the display buffers until the next call to flushAll().
+     * @see PT6312::flushHeld
+     */
+    static void holdAll(void)
+    {
+        First::flushHeld = true;
+        int holds[] = {0, (Others::flushHeld = true, 0)...};
+        (void)holds;
+    }
+
+    /**
+     * @brief Send the modified bytes of the display buffers of all the controllers,
+     *      in the order of the template parameters.
+     *      The refresh held by holdAll() is released.
+     * @see PT6312::flush()
+     */
+    static void flushAll(void)
+    {
+        First::flushHeld = false;
+        First::flush();
+        int flushes[] = {0, (Others::flushHeld = false, Others::flush(), 0)...};
+        (void)flushes;
+    }
+
+    /**
+     * @brief Forget the bytes previously sent to all the controllers.
+     * @see PT6312::invalidate()
+     */
+    static void invalidateAll(void)
+    {
+        First::invalidate();
+        int invalidations[] = {0, (Others::invalidate(), 0)...};
+        (void)invalidations;
+    }
+
+    /**
+     * @brief Set the brightness of all the controllers.
+     * @see PT6312::setBrightness()
+     */
+    static void setBrightness(const uint8_t brightness)
+    {
+        First::setBrightness(brightness);
+        int commands[] = {0, (Others::setBrightness(brightness), 0)...};
+        (void)commands;
+    }
+
+    /**
+     * @brief Test if the bus can be used: no locked sequence and no transmission
+     *      in progress with any of the controllers (all CS/Strobe lines HIGH,
+     *      transmit queue empty if VFD_TX_QUEUE_SIZE is set).
+     */
+    static inline bool isIdle(void)
+    {
+        #if VFD_TX_QUEUE_SIZE > 0
+        return !vfd_bus_locked && VFD_csLinesHigh((First *)0, (Others *)0 ...) && VFD_txEmpty();
+        #else
+        return !vfd_bus_locked && VFD_csLinesHigh((First *)0, (Others *)0 ...);
+        #endif
+    }
+};
+
+#endif
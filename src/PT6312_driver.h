@@ -0,0 +1,1283 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * Based on the work of 2017 Istrate Liviu - <istrateliviu24@yahoo.com>
+ * Itself inspired by http://www.instructables.com/id/A-DVD-Player-Hack/
+ * Also inspired from https://os.mbed.com/users/wim/code/mbed_PT6312/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Driver of a PT6312 controller; pins, geometry and display layout are template parameters.
+ * This file is included by PT6312.h.
+ */
+#ifndef PT6312_DRIVER_H
+#define PT6312_DRIVER_H
+
+/**
+ * Driver of a PT6312 controller.
+ *
+ * All the members are static: a driver is a type, not an object, and each
+ * configuration gets its own buffers and specialized code.
+ * Pins are resolved at compile time to constant port/bit operations.
+ *
+ * @tparam CsPin, SclkPin, DataPin Pin types (see VFD_DEFINE_PIN() in pins.h).
+ * @tparam Grids Number of grids of the display (range 4..11).
+ * @tparam Layout Display layout: font, writeString() and spinner frames
+ *      (Ex: VFD_Variant1::Layout, see display_variants/).
+ * @tparam Transport VFD_TRANSPORT_BITBANG (default) or the transport configured
+ *      by VFD_TRANSPORT in global.h (SclkPin/DataPin must be the pins of the USI/SPI).
+ *
+ * Ex:
+ *      VFD_DEFINE_PORT_PIN(CsPin, B, 3);
+ *      typedef PT6312<CsPin, SclkPin, DataPin, 5, VFD_Variant2::Layout> SecondDisplay;
+ *      SecondDisplay::initialize();
+ *      SecondDisplay::setGridCursor(1);
+ *      SecondDisplay::writeString("HELLO", false);
+ */
+template<class CsPin, class SclkPin, class DataPin, uint8_t Grids, class Layout,
+         uint8_t Transport = VFD_TRANSPORT_BITBANG>
+class PT6312
+{
+    static_assert((Grids >= 4) && (Grids <= 11), "Grids must be in range 4..11");
+    static_assert((Transport == VFD_TRANSPORT_BITBANG) || (Transport == VFD_TRANSPORT),
+                  "The hardware transport is configured by VFD_TRANSPORT in global.h");
+
+public:
+    typedef CsPin   Cs;
+    typedef SclkPin Sclk;
+    typedef DataPin Data;
+    typedef Layout  DisplayLayout;
+
+    // Number of grids
+    static constexpr uint8_t grids         = Grids;
+    // Memory size in bytes of the display
+    static constexpr uint8_t displayMemory = Grids * PT6312_BYTES_PER_GRID;
+    // Number of segments per grid
+    static constexpr uint8_t segments      = (Grids <= 6) ? 16 : 22 - Grids;
+    // Display mode setting (PT6312_GR4_SEG16..PT6312_GR11_SEG11)
+    static constexpr uint8_t displayMode   = PT6312_MODE_SET_CMD | (Grids - 4);
+    // VFD_TRANSPORT_BITBANG or VFD_TRANSPORT
+    static constexpr uint8_t transport     = Transport;
+
+    // Grid cursor (starting from 1)
+    static uint8_t gridCursor;
+    // Layers of the display, 2 bytes (16 segments) per grid, merged by an OR on flush():
+    // Text: written by all drawing functions
+    static uint8_t displayBuffer[displayMemory];
+    // Animations: written by busySpinningCircleFrame()
+    static uint8_t animationBuffer[displayMemory];
+    // If set, flush() does nothing: drawing functions only update displayBuffer
+    // (Ex: batched refresh of several controllers, see VFD_Bus::flushAll())
+    static bool    flushHeld;
+    #if ENABLE_ICON_BUFFER == 1
+    // Icons: written by setIcon(), clearIcon()
+    static uint8_t iconBuffer[displayMemory];
+    #endif
+
+    static void initialize(void);
+    static void configurePins(void);
+    static void waitPowerUp(void);
+    static void configureController(void);
+    static void resetDisplay(void);
+    static void setBrightness(const uint8_t brightness);
+    static void setDisplayControl(uint8_t value, bool force=false);
+    static void setDataSetting(uint8_t value, bool force=false);
+    static void clear(void);
+    static void flush(void);
+    static void flushRange(uint8_t address, uint8_t length);
+    static void flushLayers(void);
+    static void invalidate(void);
+
+    static void setGridCursor(uint8_t position);
+    static inline void writeString(const char *string, bool colon_symbol);
+    static inline uint8_t busySpinningCircleFrame(uint8_t address, uint8_t frame_number, uint8_t loop_number);
+    static void displayAllSegments(void);
+    static void clearAnimations(void);
+
+    #if ENABLE_ICON_BUFFER == 1
+    static void setIcon(uint8_t icon_font_index);
+    static void clearIcon(uint8_t icon_font_index);
+    static void clearIcons(void);
+    #endif
+
+    static void setLEDs(uint8_t leds);
+    static uint32_t getKeys(void);
+    static uint8_t getKeyPressed(void);
+    static uint8_t getSwitches(void);
+    static bool isResponding(void);
+
+    static void command(uint8_t value, bool cmd=false);
+    static inline void CSSignal(void);
+    static void txSend(uint8_t value, uint8_t flags);
+    static uint8_t readByte(void);
+    static void writeByte(uint8_t address, char data);
+    static void writeBlock(uint8_t address, const uint8_t *data, uint8_t length);
+    static inline bool isBusIdle(void);
+
+private:
+    // Bytes of the display memory of the controller as they were last sent
+    static uint8_t controllerMemory[displayMemory];
+    // Set when the content of the controller memory is unknown
+    static bool    controllerMemoryInvalid;
+    // Last display control and data setting commands sent (0: unknown),
+    // see setDisplayControl(), setDataSetting()
+    static volatile uint8_t displayControlState;
+    static volatile uint8_t dataSettingState;
+    // Grids whose icons or animations changed since the last flush (bit 0: grid 1),
+    // see flushLayers()
+    static volatile uint16_t layersChanged;
+    #if VFD_TX_QUEUE_SIZE > 0
+    // Index of the controller in the transmit queue (see VFD_txRegister())
+    static uint8_t txIndex;
+    // Set between the start and the end of a transmission, queued or not
+    static volatile bool txOpen;
+    #endif
+    // Data setting of the writes to the display memory
+    static constexpr uint8_t dataWriteSetting =
+        PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR;
+    // Bytes exchanged by the USI/SPI peripheral of the MCU (VFD_transferByte())
+    static constexpr bool peripheral =
+        (Transport == VFD_TRANSPORT_USI) || (Transport == VFD_TRANSPORT_SPI);
+
+    static inline uint8_t composeByte(uint8_t address);
+    static inline bool isDirty(uint8_t address);
+    static inline void markLayers(uint8_t address, uint8_t length);
+    static void sendByte(uint8_t value);
+    static void receive(uint8_t *data, uint8_t length);
+    static inline uint8_t shiftIn(void);
+    static inline void transmit(uint8_t value, uint8_t flags);
+    static inline bool isTransmitting(void);
+    static inline bool beginRead(void);
+    static inline void endRead(bool direct);
+    static uint8_t readSwitchByte(void);
+    #if ENABLE_ICON_BUFFER == 1
+    static inline uint8_t iconAddress(uint8_t icon_font_index, uint8_t &mask);
+    #endif
+};
+
+
+#define VFD_DRIVER_TEMPLATE \
+    template<class CsPin, class SclkPin, class DataPin, uint8_t Grids, class Layout, uint8_t Transport>
+#define VFD_DRIVER PT6312<CsPin, SclkPin, DataPin, Grids, Layout, Transport>
+
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::gridCursor;
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::displayBuffer[VFD_DRIVER::displayMemory];
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::animationBuffer[VFD_DRIVER::displayMemory];
+VFD_DRIVER_TEMPLATE bool    VFD_DRIVER::flushHeld;
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::controllerMemory[VFD_DRIVER::displayMemory];
+VFD_DRIVER_TEMPLATE bool    VFD_DRIVER::controllerMemoryInvalid = true;
+VFD_DRIVER_TEMPLATE volatile uint8_t VFD_DRIVER::displayControlState;
+VFD_DRIVER_TEMPLATE volatile uint8_t VFD_DRIVER::dataSettingState;
+#if VFD_TX_QUEUE_SIZE > 0
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::txIndex = VFD_TX_SENDERS;
+VFD_DRIVER_TEMPLATE volatile bool VFD_DRIVER::txOpen;
+#endif
+VFD_DRIVER_TEMPLATE volatile uint16_t VFD_DRIVER::layersChanged;
+#if ENABLE_ICON_BUFFER == 1
+VFD_DRIVER_TEMPLATE uint8_t VFD_DRIVER::iconBuffer[VFD_DRIVER::displayMemory];
+#endif
+
+
+/**
+ * @brief Configure the controller and the pins of the MCU.
+ * @see VFD_Bus::initialize() for controllers sharing SCLK/DATA lines.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::initialize(void)
+{
+    configurePins();
+
+    // Waiting for the VFD driver to startup
+    waitPowerUp();
+
+    configureController();
+}
+
+
+/**
+ * @brief Configure the pins of the MCU (and the hardware transport if any),
+ *      first step of initialize().
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::configurePins(void)
+{
+    // Idle levels: no transmission, SCLK HIGH
+    // (set before the pins become outputs to avoid a glitch on the lines)
+    CsPin::high();
+    SclkPin::high();
+    CsPin::output();
+    SclkPin::output();
+    DataPin::output();
+
+    if (peripheral) {
+        VFD_transportInitialize();
+    }
+
+    #if VFD_TX_QUEUE_SIZE > 0
+    txIndex = VFD_txRegister(txSend);
+    #endif
+}
+
+
+/**
+ * @brief Wait for the startup of the controller: VFD_POWER_UP_DELAY milliseconds,
+ *      less if VFD_POWER_UP_PROBE is set and the controller answers before.
+ *      The pins must be configured (configurePins()).
+ * @see isResponding()
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::waitPowerUp(void)
+{
+    #if VFD_POWER_UP_PROBE == 1
+    for (uint16_t elapsed_ms = 0; elapsed_ms < VFD_POWER_UP_DELAY; elapsed_ms++) {
+        if (isResponding()) {
+            return;
+        }
+        _delay_ms(1);
+    }
+    #else
+    _delay_ms(VFD_POWER_UP_DELAY);
+    #endif
+}
+
+
+/**
+ * @brief Configure the controller (display mode, brightness) and clear its memory,
+ *      second step of initialize().
+ *      The controller must be started (see waitPowerUp()).
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::configureController(void)
+{
+    // State of the controller unknown (power-on)
+    invalidate();
+
+    // Set display mode (number of digits & segments)
+    command(displayMode, true);
+
+    resetDisplay();
+
+    // Clear the random content of the controller memory at startup
+    flush();
+
+    gridCursor = 1;
+}
+
+
+/**
+ * @brief Reset the controller
+ *      - Turn on the display with the brightness in use (Ex: set by a fade),
+ *        the default brightness if the display is off or after a mode setting
+ *      - Init default command mode (write to memory, auto increment the memory address)
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::resetDisplay(void)
+{
+    // Turn on the display
+    // Display control cmd, display on, last brightness sent or default brightness
+    uint8_t control = displayControlState;
+    if (!(control & PT6312_DSP_ON)) {
+        control = PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | PT6312_BRT_DEF;
+    }
+    setDisplayControl(control, VFD_WAKE_UP_RESEND);
+
+    // Data set cmd, normal mode, auto incr, write data to memory
+    setDataSetting(dataWriteSetting, VFD_WAKE_UP_RESEND);
+}
+
+
+/**
+ * @brief Set display brightness
+ *      Nothing is sent if the display is already on with this brightness,
+ *      unless VFD_WAKE_UP_RESEND is set.
+ * @param brightness Valid range 0..7
+ *      for 1/16, 2/16, 4/16, 10/16, 11/16, 12/16, 13/16, 14/16 dutycycles.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setBrightness(const uint8_t brightness)
+{
+    // Display control cmd, display on/off, brightness
+    // mask invalid bits with PT6312_BRT_MSK
+    setDisplayControl(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | (brightness & PT6312_BRT_MSK), VFD_WAKE_UP_RESEND);
+
+    #if VFD_WAKE_UP_RESEND == 1
+    // Don't really know why, but this line (or a set mode command) is required to wake up the display
+    // Data set cmd, normal mode, auto incr, write data to memory
+    setDataSetting(dataWriteSetting, true);
+    #endif
+}
+
+
+/**
+ * @brief Send a display control command if it differs from the last one sent.
+ * @param value Display control command (PT6312_DSP_CTRL_CMD | PT6312_DSP_ON/OFF | brightness).
+ * @param force (Optional) Send the command anyway. Default: false
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setDisplayControl(uint8_t value, bool force)
+{
+    if (force || value != displayControlState) {
+        command(value, true);
+    }
+}
+
+
+/**
+ * @brief Send a data setting command if it differs from the last one sent.
+ *      Key/switch reads and LED writes leave their data setting in the controller;
+ *      the write mode is restored by the next write to the display memory (writeBlock()).
+ * @param value Data setting command (PT6312_DATA_SET_CMD | mode | address | read/write).
+ * @param force (Optional) Send the command anyway. Default: false
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setDataSetting(uint8_t value, bool force)
+{
+    if (force || value != dataSettingState) {
+        command(value, true);
+    }
+}
+
+
+/**
+ * @brief Clear the display by turning off all segments of the text and animations.
+ *      If ENABLE_ICON_BUFFER is enabled, icons are kept on the display.
+ * @see clearIcons()
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::clear(void)
+{
+    for (uint8_t i = 0; i < displayMemory; i++) {
+        displayBuffer[i]   = 0;
+        animationBuffer[i] = 0;
+    }
+    flush();
+    gridCursor = Grids;
+}
+
+
+/**
+ * @brief Get the byte that must be in the controller memory at the given address:
+ *      merge of the text, icons and animations layers.
+ */
+VFD_DRIVER_TEMPLATE
+inline uint8_t VFD_DRIVER::composeByte(uint8_t address)
+{
+    #if ENABLE_ICON_BUFFER == 1
+    return displayBuffer[address] | iconBuffer[address] | animationBuffer[address];
+    #else
+    return displayBuffer[address] | animationBuffer[address];
+    #endif
+}
+
+
+/**
+ * @brief Mark the grids of the given bytes of the icons or animations layers as changed.
+ * @see flushLayers()
+ */
+VFD_DRIVER_TEMPLATE
+inline void VFD_DRIVER::markLayers(uint8_t address, uint8_t length)
+{
+    uint8_t  first = address / PT6312_BYTES_PER_GRID;
+    uint8_t  last  = (address + length - 1) / PT6312_BYTES_PER_GRID;
+    uint16_t grids = ((2U << last) - 1) & ~((1U << first) - 1);
+
+    #if ENABLE_TIMER == 1
+    // Also marked by the timer interrupt (spinner)
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    #endif
+    {
+        layersChanged |= grids;
+    }
+}
+
+
+/**
+ * @brief Test if the byte at the given address must be sent to the controller.
+ */
+VFD_DRIVER_TEMPLATE
+inline bool VFD_DRIVER::isDirty(uint8_t address)
+{
+    return controllerMemoryInvalid || composeByte(address) != controllerMemory[address];
+}
+
+
+/**
+ * @brief Send the modified bytes of the layers (text, icons, animations) to the controller.
+ *      Bytes are compared to the ones previously sent; only the ranges of
+ *      modified addresses are transmitted, each one in a single burst
+ *      (see writeBlock()).
+ *      A single unmodified byte between 2 modified ones is sent anyway since it costs
+ *      less than a new CS strobe and address command.
+ *      Nothing is sent while flushHeld is set.
+ * @see invalidate()
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::flush(void)
+{
+    if (flushHeld) {
+        return;
+    }
+
+    uint8_t address = 0;
+
+    while (address < displayMemory) {
+        if (!isDirty(address)) {
+            address++;
+            continue;
+        }
+
+        // Find the end of the range
+        uint8_t start = address;
+        do {
+            address++;
+        } while ((address < displayMemory)
+                 && (isDirty(address)
+                     || ((address + 1 < displayMemory) && isDirty(address + 1))));
+
+        flushRange(start, address - start);
+    }
+    controllerMemoryInvalid = false;
+    layersChanged           = 0;
+}
+
+
+/**
+ * @brief Send the given bytes of the layers (text, icons, animations) to the controller,
+ *      whether they are modified or not.
+ * @param address Address of the first byte.
+ * @param length Number of bytes to send.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::flushRange(uint8_t address, uint8_t length)
+{
+    for (uint8_t i = address; i < address + length; i++) {
+        controllerMemory[i] = composeByte(i);
+    }
+    writeBlock(address, &controllerMemory[address], length);
+}
+
+
+/**
+ * @brief Send only the grids whose icons or animations changed since the last flush,
+ *      without comparing the rest of the display.
+ *      Each run of consecutive grids is sent in a single burst, if one of its bytes
+ *      differs from the controller memory.
+ *      To be used after setIcon(), clearIcon() or an animation frame when the text is unchanged;
+ *      the pending modifications of the text in these grids are sent along.
+ *      Nothing is sent while flushHeld is set.
+ * @see flush()
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::flushLayers(void)
+{
+    if (flushHeld) {
+        return;
+    }
+
+    uint16_t changed;
+    #if ENABLE_TIMER == 1
+    // The grids marked by the timer interrupt meanwhile must not be lost
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    #endif
+    {
+        changed = layersChanged;
+        layersChanged = 0;
+    }
+
+    uint8_t grid = 0;
+    while (changed) {
+        if (!(changed & 1)) {
+            changed >>= 1;
+            grid++;
+            continue;
+        }
+        uint8_t first = grid * PT6312_BYTES_PER_GRID;
+        bool    dirty = false;
+        while (changed & 1) {
+            for (uint8_t i = 0; i < PT6312_BYTES_PER_GRID; i++) {
+                dirty |= isDirty(grid * PT6312_BYTES_PER_GRID + i);
+            }
+            changed >>= 1;
+            grid++;
+        }
+        if (dirty) {
+            flushRange(first, grid * PT6312_BYTES_PER_GRID - first);
+        }
+    }
+}
+
+
+/**
+ * @brief Forget the bytes and commands previously sent to the controller.
+ *      The next call to flush() will send the whole display buffer, the next
+ *      commands are sent even if they are unchanged.
+ *      Should be used after raw writes to the controller memory with command(),
+ *      or if the controller was reset.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::invalidate(void)
+{
+    controllerMemoryInvalid = true;
+    displayControlState     = 0;
+    dataSettingState        = 0;
+}
+
+
+/**
+ * @brief Set the cursor on the display buffer according to the given grid position.
+ *      The first address of a grid will be selected for writing.
+ *      Should be used BEFORE writing segments data.
+ *      Ex: If PT6312_BYTES_PER_GRID == 2 (default), position 1 relies on the first grid,
+ *      the memory address in displayBuffer will be 0.
+ *      Position 2 relies on the 2nd grid, the address will be 2 (2 bytes further).
+ * @param position Position where the next segments will be written.
+ *      Valid range 1..Grids.
+ *      If position == Grids + 1: The first grid will be selected.
+ *      If position > Grids + 1 or position == 0: The last grid will be selected.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setGridCursor(uint8_t position)
+{
+    if (position > Grids) {
+        if (position == Grids + 1) {
+            position = 1;
+        }else{
+            position = Grids;
+        }
+    }else if (position == 0) {
+        position = Grids;
+    }
+
+    gridCursor = position;
+}
+
+
+/**
+ * @brief Write a string of characters present in the font of the layout,
+ *      from the grid cursor.
+ * @see Layout::writeString() in display_variants/.
+ */
+VFD_DRIVER_TEMPLATE
+inline void VFD_DRIVER::writeString(const char *string, bool colon_symbol)
+{
+    Layout::template writeString<PT6312>(string, colon_symbol);
+}
+
+
+/**
+ * @brief Draw a frame of the busy spinning circle in animationBuffer.
+ * @see Layout::busySpinningCircleFrame() in display_variants/.
+ */
+VFD_DRIVER_TEMPLATE
+inline uint8_t VFD_DRIVER::busySpinningCircleFrame(uint8_t address, uint8_t frame_number, uint8_t loop_number)
+{
+    uint8_t first = Layout::template busySpinningCircleFrame<PT6312>(address, frame_number, loop_number);
+    markLayers(first, Layout::spinnerBytes);
+    return first;
+}
+
+
+/**
+ * @brief Turn off the segments of the animations layer (busy spinning circle).
+ *      The segments will be turned off on the next call to flush() or flushLayers().
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::clearAnimations(void)
+{
+    for (uint8_t i = 0; i < displayMemory; i++) {
+        animationBuffer[i] = 0;
+    }
+    markLayers(0, displayMemory);
+}
+
+
+/**
+ * @brief Test the display of all segments of the display.
+ *      It's the opposite of clear().
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::displayAllSegments(void)
+{
+    for (uint8_t i = 0; i < displayMemory; i++) {
+        displayBuffer[i] = 255;
+    }
+    flush();
+
+    gridCursor = Grids;
+
+    // Reset/Update display
+    // => Don't know why but it appears to be mandatory to avoid forever black screen... (?)
+    // See VFD_busySpinningCircle() (same behavior)
+    resetDisplay();
+}
+
+
+#if ENABLE_ICON_BUFFER == 1
+/**
+ * @brief Get the address of an icon in the icon buffer.
+ * @param icon_font_index Index of the icon in the icons font of the layout.
+ * @param mask Set to the bit of the icon at the returned address.
+ */
+VFD_DRIVER_TEMPLATE
+inline uint8_t VFD_DRIVER::iconAddress(uint8_t icon_font_index, uint8_t &mask)
+{
+    // Get memory address from grid
+    // Grid obtained starts from 0
+    // Ex: for grid=1: (1+1)*2-2 = 2
+    uint8_t icon    = Layout::iconFont(icon_font_index);
+    uint8_t addr    = (icon & 0x0F) * PT6312_BYTES_PER_GRID;
+    uint8_t segment = icon >> 4;
+
+    // Address in the icon buffer depends on the localization of the segment
+    // (LSB or MSB)
+    if (segment < 8) {
+        // LSB
+        mask = 1 << segment;
+        return addr;
+    }
+    // MSB
+    mask = 1 << (segment - 8);
+    return addr + 1;
+}
+
+
+/**
+ * @brief Add an icon to the buffer.
+ *      The icon will be displayed on the next call to flush()
+ *      (made by all the drawing functions) or flushLayers().
+ * @param icon_font_index Index of the icon in the icons font of the layout.
+ *      Defines can be used.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setIcon(uint8_t icon_font_index)
+{
+    uint8_t mask;
+    uint8_t addr = iconAddress(icon_font_index, mask);
+
+    iconBuffer[addr] |= mask;
+    markLayers(addr, 1);
+}
+
+
+/**
+ * @brief Remove an icon from the buffer.
+ *      The icon will be removed on the next call to flush()
+ *      (made by all the drawing functions) or flushLayers().
+ * @param icon_font_index Index of the icon in the icons font of the layout.
+ *      Defines can be used.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::clearIcon(uint8_t icon_font_index)
+{
+    uint8_t mask;
+    uint8_t addr = iconAddress(icon_font_index, mask);
+
+    iconBuffer[addr] &= ~mask;
+    markLayers(addr, 1);
+}
+
+
+/**
+ * @brief Clear the icon buffer.
+ *      All the icons will be removed on the next call to flush()
+ *      (made by all the drawing functions) or flushLayers().
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::clearIcons(void)
+{
+    for (uint8_t i = 0; i < displayMemory; i++)
+    {
+        iconBuffer[i] = 0;
+    }
+    markLayers(0, displayMemory);
+}
+#endif
+
+
+/**
+ * @brief Set status of LEDs.
+ *      Up to 4 LEDs can be controlled.
+ * @param leds Byte where the 4 least significant bits are used.
+ *      Set a bit to 1 to turn on a LED.
+ *      Bit 0: LED 1
+ *      ...
+ *      Bit 3: LED 4
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::setLEDs(uint8_t leds)
+{
+    vfd_bus_locked = true;
+
+    // Enable LED Read mode
+    // Data set cmd, normal mode, auto incr, write data to LED port
+    command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_LED_WR, false);
+
+    // Invert the bits:
+    // 0: LED lights
+    // 1: LED turns off
+    leds = ~leds;
+
+    command(leds & PT6312_LED_MSK, true);
+
+    // Data Write mode is restored by the next write to the display memory
+
+    vfd_bus_locked = false;
+}
+
+
+/**
+ * @brief Get status of keys
+ *      Keys status are stored in the 3 least significant bytes of a uint32_t.
+ *      Each of the 4 keys is sampled 6 times.
+ *      In a sample, 4 bits for keys: 0, 1, 2, 3 (from least to most significant bit).
+ *      If a key is pressed raw_keys is > 0.
+ *      Sample Masks:
+ *          Sample 0: raw_keys & 0x0F
+ *          Sample 1: (raw_keys >> 4) & 0x0F
+ *          Sample 2: (raw_keys >> 8) & 0x0F
+ *          Sample 3: (raw_keys >> 12) & 0x0F
+ *          Sample 4: (raw_keys >> 16) & 0x0F
+ *          Sample 5: (raw_keys >> 20) & 0x0F
+ * @return 6 samples of 4 bits each in the 3 least significant bytes of a uint32_t
+ */
+VFD_DRIVER_TEMPLATE
+uint32_t VFD_DRIVER::getKeys(void)
+{
+    vfd_bus_locked = true;
+    bool direct = beginRead();
+
+    // Enable Key Read mode
+    // Data set cmd, normal mode, auto incr, read data
+    command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_KEY_RD, false);
+
+    // Read the key matrix of size PT6312_KEY_MEM bytes
+    // 3 bytes = 3 readings
+    uint8_t key_memory[PT6312_KEY_MEM];
+    receive(key_memory, PT6312_KEY_MEM);
+
+    CSSignal();
+
+    uint32_t raw_keys = PT6312_KEY_MSK & key_memory[0];
+    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & key_memory[1]);
+    raw_keys = (raw_keys << 8) + (PT6312_KEY_MSK & key_memory[2]);
+
+    // Data Write mode is restored by the next write to the display memory
+
+    endRead(direct);
+    vfd_bus_locked = false;
+
+    return raw_keys;
+}
+
+
+/**
+ * @brief Get the number of the first pressed button (no multi buttons)
+ *      Button 0: 1
+ *      ...
+ *      Button 3: 4
+ * @see getKeys()
+ * @return The number of the first pressed button or 0 if no button is pressed.
+ */
+VFD_DRIVER_TEMPLATE
+uint8_t VFD_DRIVER::getKeyPressed(void)
+{
+    uint8_t btn_nr = 1, pressed_btn = 0;
+
+    // Get 1 sample (6th sample): Last 4 bits of the uint32_t
+    pressed_btn = PT6312_KEY_SMPL_MSK & PT6312_KEY_MSK & getKeys();
+    if (pressed_btn > 0) {
+        // Return the button number
+        while (((1 << (btn_nr - 1)) & pressed_btn) == 0) {
+            btn_nr++;
+        }
+        return btn_nr;
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Get status of switches
+ *      Switches status are stored in the last 4 bits of the returned byte.
+ *      The first (lowest) bit represents switch 0.
+ *      Ex: 0b....0001
+ *                   |
+ *                   switch 0 is pressed
+ */
+VFD_DRIVER_TEMPLATE
+uint8_t VFD_DRIVER::getSwitches(void)
+{
+    return PT6312_SW_MSK & readSwitchByte();
+}
+
+
+/**
+ * @brief Test if the controller is started, by a switch read: only the 4 least significant
+ *      bits carry the switches, the others are read as 0. A controller that is not powered
+ *      or not started yet doesn't drive the DATA line, which is pulled up: 0xFF is read.
+ *      Nothing is displayed; the write mode is restored by the next write to the display memory.
+ * @see waitPowerUp(), VFD_POWER_UP_PROBE in global.h
+ */
+VFD_DRIVER_TEMPLATE
+bool VFD_DRIVER::isResponding(void)
+{
+    return !(readSwitchByte() & ~PT6312_SW_MSK);
+}
+
+
+/**
+ * @brief Read the byte of the switches, without masking the unused bits.
+ */
+VFD_DRIVER_TEMPLATE
+uint8_t VFD_DRIVER::readSwitchByte(void)
+{
+    vfd_bus_locked = true;
+    bool direct = beginRead();
+
+    // Enable Switch Read mode
+    // Data set cmd, normal mode, auto incr, read data
+    command(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_SW_RD, false);
+
+    uint8_t raw_switches;
+    receive(&raw_switches, 1);
+
+    CSSignal();
+
+    // Data Write mode is restored by the next write to the display memory
+
+    endRead(direct);
+    vfd_bus_locked = false;
+
+    return raw_switches;
+}
+
+
+/**
+ * @brief Send a byte in a write command to the controller
+ *      The first byte of a transmission is a command: display control and data
+ *      setting commands are remembered (see setDisplayControl(), setDataSetting()).
+ * @param value Byte to send.
+ * @param cmd (Optional)
+ *      If True, the CS/Strobe line is asserted to HIGH (end of transmission)
+ *      after the byte has been sent.
+ *      Default: false
+ * @note After a key/switch read or a LED write, the controller is not in write mode;
+ *      raw writes to the display memory must be preceded by
+ *      setDataSetting(PT6312_DATA_SET_CMD | PT6312_MODE_NORM | PT6312_ADDR_INC | PT6312_DATA_WR).
+ * @note If VFD_TX_QUEUE_SIZE is set, the byte is queued and sent later by the timer
+ *      interrupt (see VFD_txFence()).
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::command(uint8_t value, bool cmd)
+{
+    #if VFD_STATS == 1
+    uint32_t start = VFD_statsCycles();
+    #endif
+
+    if (!isTransmitting()) {
+        switch (value & 0xC0) {
+        case PT6312_MODE_SET_CMD:
+            // The display may be turned off by a mode change
+            displayControlState = 0;
+            break;
+        case PT6312_DATA_SET_CMD:
+            dataSettingState = value;
+            #if VFD_STATS == 1
+            VFD_stats.modeSwitches++;
+            #endif
+            break;
+        case PT6312_DSP_CTRL_CMD:
+            displayControlState = value;
+            break;
+        }
+    }
+
+    transmit(value, (isTransmitting() ? 0 : VFD_TX_START) | VFD_TX_DATA | (cmd ? VFD_TX_END : 0));
+
+    #if VFD_STATS == 1
+    VFD_stats.commands++;
+    VFD_stats.commandCycles += VFD_statsCycles() - start;
+    #endif
+}
+
+
+/**
+ * @brief Signal the driver that the data transmission is over
+ *      The CS/Strobe line is asserted to HIGH (end of transmission).
+ *      Queued if VFD_TX_QUEUE_SIZE is set, like the bytes of command().
+ */
+VFD_DRIVER_TEMPLATE
+inline void VFD_DRIVER::CSSignal(void)
+{
+    transmit(0, VFD_TX_END);
+}
+
+
+/**
+ * @brief Perform a step of a transmission on the lines of the controller.
+ *      Called for each queued byte by the timer interrupt if VFD_TX_QUEUE_SIZE is set
+ *      (see VFD_txRegister()), directly otherwise.
+ * @param value Byte to send (if VFD_TX_DATA is set).
+ * @param flags Combination of VFD_TX_START (CS/Strobe line LOW before the byte),
+ *      VFD_TX_DATA and VFD_TX_END (CS/Strobe line HIGH after the byte).
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::txSend(uint8_t value, uint8_t flags)
+{
+    #if VFD_TRACE_HOOKS == 1
+    if (flags & VFD_TX_START) {
+        VFD_transactionBegin();
+    }
+    #endif
+    #if VFD_STATS == 1
+    if (flags & VFD_TX_DATA) {
+        VFD_stats.bytesSent++;
+    }
+    if (flags & VFD_TX_END) {
+        VFD_stats.csStrobes++;
+    }
+    #endif
+
+    #ifdef VFD_LINUX
+    if (Transport == VFD_TRANSPORT_LINUX) {
+        // The backend passes the whole transaction to the GPIO interface at its end
+        VFD_linuxTransmit(CsPin::line, SclkPin::line, DataPin::line, value, flags);
+    }else
+    #endif
+    {
+        if (flags & VFD_TX_START) {
+            CsPin::low();
+            _delay_us(1); // NOTE: not in datasheet
+        }
+        if (flags & VFD_TX_DATA) {
+            sendByte(value);
+        }
+        if (flags & VFD_TX_END) {
+            _delay_us(1);
+            CsPin::high();
+            _delay_us(1);
+        }
+    }
+
+    #if VFD_TRACE_HOOKS == 1
+    if (flags & VFD_TX_END) {
+        VFD_transactionEnd();
+    }
+    #endif
+}
+
+
+/**
+ * @brief Queue a step of a transmission (see txSend()), or perform it directly
+ *      if the queue is disabled or bypassed (vfd_tx_direct).
+ */
+VFD_DRIVER_TEMPLATE
+inline void VFD_DRIVER::transmit(uint8_t value, uint8_t flags)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    if (flags & VFD_TX_START) {
+        txOpen = true;
+    }
+    if (flags & VFD_TX_END) {
+        txOpen = false;
+    }
+    if (!vfd_tx_direct) {
+        if (txIndex < VFD_TX_SENDERS) {
+            VFD_txPush(value, flags | (txIndex << 4));
+            return;
+        }
+        // Too many controllers for the queue: transmission in order, after the queued ones
+        VFD_txFence();
+    }
+    #endif
+    txSend(value, flags);
+}
+
+
+/**
+ * @brief Test if a transmission is started and not ended (CS/Strobe line LOW,
+ *      or will be once the queued bytes are sent).
+ */
+VFD_DRIVER_TEMPLATE
+inline bool VFD_DRIVER::isTransmitting(void)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    return txOpen;
+    #else
+    return !CsPin::isHigh();
+    #endif
+}
+
+
+/**
+ * @brief Prepare a read: the reads are synchronous, the queued transmissions
+ *      are sent first, then the queue is bypassed until endRead().
+ *      The bus must be locked (vfd_bus_locked).
+ * @return State to give to endRead().
+ */
+VFD_DRIVER_TEMPLATE
+inline bool VFD_DRIVER::beginRead(void)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    VFD_txFence();
+    bool direct = vfd_tx_direct;
+    vfd_tx_direct = true;
+    return direct;
+    #else
+    return true;
+    #endif
+}
+
+
+/**
+ * @brief End of a read, see beginRead().
+ */
+VFD_DRIVER_TEMPLATE
+inline void VFD_DRIVER::endRead(bool direct)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    vfd_tx_direct = direct;
+    #else
+    (void)direct;
+    #endif
+}
+
+
+/**
+ * @brief Test if a background task (timer interrupt) can use the bus:
+ *      no transmission in progress (CS/Strobe line HIGH), no locked sequence
+ *      and no queued byte (if VFD_TX_QUEUE_SIZE is set).
+ * @note Only the CS/Strobe line of this controller is tested; the blocks written
+ *      to the other controllers of a shared bus lock it (see writeBlock()).
+ *      The background features use VFD_busIdle() (VFD_Bus::isIdle() for a shared bus).
+ */
+VFD_DRIVER_TEMPLATE
+inline bool VFD_DRIVER::isBusIdle(void)
+{
+    #if VFD_TX_QUEUE_SIZE > 0
+    return !vfd_bus_locked && CsPin::isHigh() && VFD_txEmpty();
+    #else
+    return !vfd_bus_locked && CsPin::isHigh();
+    #endif
+}
+
+
+/**
+ * @brief Write consecutive bytes in the controller memory in a single transmission.
+ *      The address command is sent once, then the bytes are streamed while the
+ *      CS/Strobe line stays LOW; the controller increments the address after each
+ *      byte (PT6312_ADDR_INC data setting, restored here if needed).
+ * @param address Address of the first byte (range 0x00..0x15 (22 addresses)).
+ * @param data Bytes to write.
+ * @param length Number of bytes to write.
+ * @note The CS/Strobe line is asserted to HIGH (end of transmission) at the end.
+ *      displayBuffer is NOT updated, see flush() to use the display buffer.
+ * @note The bus is locked during the transmission: SCLK/DATA lines may be shared
+ *      with controllers that are refreshed by the timer interrupt.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::writeBlock(uint8_t address, const uint8_t *data, uint8_t length)
+{
+    bool bus_locked = vfd_bus_locked;
+    vfd_bus_locked = true;
+
+    // Write mode, if a key/switch read or a LED write occurred since the last write
+    setDataSetting(dataWriteSetting);
+
+    // The address command opens the transmission: it can't be skipped even if
+    // the address follows the previous write
+    command(PT6312_ADDR_SET_CMD | (address & PT6312_ADDR_MSK), false);
+
+    while (length--) {
+        transmit(*data++, VFD_TX_DATA);
+    }
+
+    // Signal the driver that the data transmission is over
+    CSSignal();
+
+    vfd_bus_locked = bus_locked;
+}
+
+
+/**
+ * @brief Shift a byte to the controller, the CS/Strobe line must already be LOW.
+ * @param value Byte to send.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::sendByte(uint8_t value)
+{
+    if (peripheral) {
+        VFD_transferByte(value);
+        return;
+    }
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        SclkPin::low();
+
+        if (value & (1 << i)) {
+            DataPin::high();
+        }else{
+            DataPin::low();
+        }
+        // wait 500ns
+        _delay_us(0.5);
+        // Data is read at the rising edge
+        SclkPin::high();
+        _delay_us(0.5);
+    }
+}
+
+
+/**
+ * @brief Read the bytes of a key/switch read: the read command is sent, the CS/Strobe
+ *      line is still LOW. The transmission must be ended by CSSignal() right after.
+ * @param data Buffer of the bytes read.
+ * @param length Number of bytes to read.
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::receive(uint8_t *data, uint8_t length)
+{
+    #if VFD_STATS == 1
+    VFD_stats.readTransactions++;
+    #endif
+
+    #ifdef VFD_LINUX
+    if (Transport == VFD_TRANSPORT_LINUX) {
+        #if VFD_STATS == 1
+        uint32_t start = VFD_statsCycles();
+        #endif
+        // Command & read in a single call to the GPIO interface,
+        // which switches the DATA line itself
+        VFD_linuxReceive(data, length, true);
+        #if VFD_STATS == 1
+        // Bytes read without readByte()
+        VFD_stats.readBytes += length;
+        VFD_stats.readCycles += VFD_statsCycles() - start;
+        #endif
+        return;
+    }
+    #endif
+
+    // Configure DATA pin input HIGH
+    DataPin::input();
+    DataPin::high();
+
+    // Here: CS is still LOW, SCLK is still HIGH
+    _delay_us(1);
+
+    while (length--) {
+        *data++ = readByte();
+    }
+
+    // Restore DATA pin as OUTPUT
+    DataPin::output();
+}
+
+
+/**
+ * @brief Obtain a byte from the controller (i.e get keys & switches status)
+ * @see getSwitches(), getKeys(), getKeyPressed().
+ * @return Byte of data
+ */
+VFD_DRIVER_TEMPLATE
+uint8_t VFD_DRIVER::readByte(void)
+{
+    #if VFD_STATS == 1
+    uint32_t start = VFD_statsCycles();
+    #endif
+
+    uint8_t data_in = shiftIn();
+
+    #if VFD_STATS == 1
+    VFD_stats.readBytes++;
+    VFD_stats.readCycles += VFD_statsCycles() - start;
+    #endif
+    return data_in;
+}
+
+
+/**
+ * @brief Shift a byte in from the controller, see readByte().
+ * @return Byte of data
+ */
+VFD_DRIVER_TEMPLATE
+inline uint8_t VFD_DRIVER::shiftIn(void)
+{
+    #ifdef VFD_LINUX
+    if (Transport == VFD_TRANSPORT_LINUX) {
+        // Read in the transaction kept by the backend, CS stays LOW
+        uint8_t data_in;
+        VFD_linuxReceive(&data_in, 1, false);
+        return data_in;
+    }
+    #endif
+
+    if (peripheral) {
+        // DATA pin is an input at this point (see getKeys()),
+        // the controller drives the DATA IN pin alone.
+        return VFD_transferByte(0xFF);
+    }
+
+    uint8_t data_in = 0xFF;
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        SclkPin::low();
+        _delay_us(0.5);
+
+        // Data is read at the falling edge
+        if (!DataPin::read()) {
+            // Bit is not set: Clear the bit
+            data_in &= ~(1 << i);
+        }
+
+        SclkPin::high();
+        _delay_us(0.5);
+    }
+    return data_in;
+}
+
+
+/**
+ * @brief Write a specific byte at the given address in the controller memory.
+ *      This function doesn't use setGridCursor() to map the position
+ *      to a grid.
+ *      The byte is sent immediately, without icons merging; displayBuffer is kept
+ *      in sync if the address is displayed.
+ * @warning Note that the CS/Strobe line is asserted to HIGH (end of transmission)
+ *      after the byte has been sent.
+ * @param address Value range 0x00..0x15 (22 addresses).
+ * @param data Byte to write at the given address.
+ * @warning Since a specific address is used, the grid cursor IS NOT updated,
+ *      and is thus more synchronized with the controller memory.
+ *      You SHOULD NOT rely on this value after using this function and use
+ *      setGridCursor().
+ */
+VFD_DRIVER_TEMPLATE
+void VFD_DRIVER::writeByte(uint8_t address, char data)
+{
+    writeBlock(address, (const uint8_t *)&data, 1);
+
+    if (address < displayMemory) {
+        displayBuffer[address]    = data;
+        controllerMemory[address] = data;
+    }
+}
+
+#undef VFD_DRIVER_TEMPLATE
+#undef VFD_DRIVER
+
+#endif
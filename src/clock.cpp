@@ -0,0 +1,332 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Clock display: time kept in packed BCD counters, only the digits that change
+ * are redrawn and only their grids are sent to the controller.
+ */
+#include "PT6312.h"
+
+#if VFD_CLOCK_TIMER == 1 && ENABLE_TIMER != 1
+    #error "VFD_CLOCK_TIMER requires ENABLE_TIMER!"
+#endif
+
+// Digits of the clock: 2 per field (seconds, minutes, hours), units first
+#define VFD_CLOCK_DIGITS    6
+// Carry of VFD_clockIncrement()
+#define VFD_CLOCK_CARRY     0x04
+
+/**
+ * State of the clock
+ * @see VFD_clockStart()
+ */
+static struct {
+    volatile bool running;
+    uint8_t       bcd[3];       // Seconds, minutes, hours in packed BCD
+    // Content of each character position: digit number (0..5, see VFD_CLOCK_DIGITS)
+    // or literal character of the format
+    char          format[VFD_DISPLAYABLE_DIGITS];
+    uint8_t       length;       // Number of characters
+    uint8_t       position;     // Character position of the first character
+    bool          blink;        // Blinking colon symbol
+    bool          colon;        // Colon symbol displayed
+    uint16_t      pending;      // Grids not sent yet (bit 0: grid 1)
+    #if VFD_CLOCK_TIMER == 1
+    uint32_t      cycles;       // CPU cycles since the last second (timer interrupts)
+    #endif
+} clock_state;
+
+
+/**
+ * @brief Add 1 to a packed BCD counter.
+ * @param value Counter (2 digits).
+ * @param max Last value of the counter before it wraps to 0 (packed BCD).
+ * @return Modified digits: bit 0: units, bit 1: tens;
+ *      VFD_CLOCK_CARRY if the counter wrapped.
+ */
+static uint8_t VFD_clockIncrement(uint8_t &value, uint8_t max)
+{
+    if (value == max) {
+        value = 0;
+        return 0x03 | VFD_CLOCK_CARRY;
+    }
+    if ((value & 0x0F) == 9) {
+        // 0x09 + 7 = 0x10
+        value += 7;
+        return 0x03;
+    }
+    value++;
+    return 0x01;
+}
+
+
+/**
+ * @brief Convert a number (range 0..99) to packed BCD.
+ */
+static uint8_t VFD_clockToBCD(uint8_t value)
+{
+    uint8_t tens = 0;
+    while (value >= 10) {
+        value -= 10;
+        tens++;
+    }
+    return (tens << 4) | value;
+}
+
+
+/**
+ * @brief Draw the characters of the clock in displayBuffer.
+ * @param digits Mask of the digits to draw (bit n: digit n, see VFD_CLOCK_DIGITS).
+ * @param literals Also draw the literal characters of the format.
+ */
+static void VFD_clockDraw(uint8_t digits, bool literals)
+{
+    for (uint8_t i = 0; i < clock_state.length; i++) {
+        char    content = clock_state.format[i];
+        uint8_t grid;
+
+        if (content < VFD_CLOCK_DIGITS) {
+            if (!(digits & (1 << content))) {
+                continue;
+            }
+            uint8_t value = clock_state.bcd[content >> 1];
+            if (content & 1) {
+                value >>= 4;
+            }
+            grid = VFD_Layout::writeChar<VFD_Driver>(clock_state.position + i, '0' + (value & 0x0F), clock_state.colon);
+        }else if (literals) {
+            grid = VFD_Layout::writeChar<VFD_Driver>(clock_state.position + i, content, clock_state.colon);
+        }else{
+            continue;
+        }
+        if (grid) {
+            clock_state.pending |= 1 << (grid - 1);
+        }
+    }
+}
+
+
+/**
+ * @brief Send the grids drawn since the last call, each run of consecutive
+ *      grids in a single burst.
+ *      The grids stay pending if the bus is in use by the main program.
+ */
+static void VFD_clockSend(void)
+{
+    #if ENABLE_TIMER == 1
+    if (!clock_state.pending || !VFD_busIdle()) {
+    #else
+    if (!clock_state.pending || !VFD_Driver::isBusIdle()) {
+    #endif
+        return;
+    }
+
+    uint16_t pending = clock_state.pending;
+    clock_state.pending = 0;
+
+    uint8_t grid = 1;
+    while (pending) {
+        if (!(pending & 1)) {
+            pending >>= 1;
+            grid++;
+            continue;
+        }
+        uint8_t first = grid;
+        while (pending & 1) {
+            pending >>= 1;
+            grid++;
+        }
+        VFD_Driver::flushRange((first - 1) * PT6312_BYTES_PER_GRID, (grid - first) * PT6312_BYTES_PER_GRID);
+    }
+}
+
+
+/**
+ * @brief Show or hide the colon symbol.
+ */
+static void VFD_clockColon(bool colon)
+{
+    clock_state.colon    = colon;
+    clock_state.pending |= VFD_Layout::setColon<VFD_Driver>(colon);
+}
+
+
+/**
+ * @brief Display a clock and start it.
+ *      The clock is advanced by the timer interrupt if VFD_CLOCK_TIMER is set,
+ *      by VFD_clockTick() otherwise.
+ *      Ex: VFD_clockStart("ssHHmm", 1, true); on a display of variant 1:
+ *      seconds on the 1 char grids, hours & minutes on each side of the colon symbol.
+ * @param format Characters of the clock, null terminated:
+ *      "HH", "mm", "ss": hours, minutes, seconds; other characters (present in the font)
+ *      are displayed as is. Characters beyond VFD_DISPLAYABLE_DIGITS are ignored.
+ * @param position Character position of the first character (range 1..VFD_DISPLAYABLE_DIGITS);
+ *      the clock is not started out of this range.
+ * @param blink_colon Blink the colon symbol (on for half a second with VFD_CLOCK_TIMER,
+ *      toggled by each VFD_clockTick() otherwise); the colon is always displayed if false.
+ * @see VFD_clockSet(), VFD_clockStop()
+ */
+void VFD_clockStart(const char *format, uint8_t position, bool blink_colon)
+{
+    clock_state.running  = false;
+    if ((position == 0) || (position > VFD_DISPLAYABLE_DIGITS)) {
+        return;
+    }
+    clock_state.position = position;
+    clock_state.blink    = blink_colon;
+    clock_state.length   = 0;
+    #if VFD_CLOCK_TIMER == 1
+    clock_state.cycles   = 0;
+    #endif
+
+    while (*format && (position + clock_state.length <= VFD_DISPLAYABLE_DIGITS)) {
+        uint8_t field;
+        switch (*format) {
+        case 's': field = 0; break;
+        case 'm': field = 1; break;
+        case 'H': field = 2; break;
+        default:
+            clock_state.format[clock_state.length++] = *format++;
+            continue;
+        }
+        // 1st letter of a pair: tens
+        bool tens = (format[1] == *format) && (format[2] != *format);
+        clock_state.format[clock_state.length++] = field * 2 + tens;
+        format++;
+    }
+
+    VFD_clockColon(true);
+    VFD_clockDraw(0xFF, true);
+    VFD_clockSend();
+
+    clock_state.running = true;
+}
+
+
+/**
+ * @brief Stop the clock started with VFD_clockStart(); the time stays displayed.
+ */
+void VFD_clockStop(void)
+{
+    clock_state.running = false;
+}
+
+
+/**
+ * @brief Set the time of the clock and display it.
+ * @param hours Range 0..23.
+ * @param minutes Range 0..59.
+ * @param seconds Range 0..59.
+ */
+void VFD_clockSet(uint8_t hours, uint8_t minutes, uint8_t seconds)
+{
+    bool running = clock_state.running;
+    clock_state.running = false;
+
+    clock_state.bcd[0] = VFD_clockToBCD(seconds);
+    clock_state.bcd[1] = VFD_clockToBCD(minutes);
+    clock_state.bcd[2] = VFD_clockToBCD(hours);
+    #if VFD_CLOCK_TIMER == 1
+    clock_state.cycles = 0;
+    #endif
+
+    VFD_clockDraw(0xFF, false);
+    VFD_clockSend();
+
+    clock_state.running = running;
+}
+
+
+/**
+ * @brief Get the time of the clock.
+ */
+void VFD_clockGet(uint8_t &hours, uint8_t &minutes, uint8_t &seconds)
+{
+    bool running = clock_state.running;
+    clock_state.running = false;
+
+    seconds = (clock_state.bcd[0] >> 4) * 10 + (clock_state.bcd[0] & 0x0F);
+    minutes = (clock_state.bcd[1] >> 4) * 10 + (clock_state.bcd[1] & 0x0F);
+    hours   = (clock_state.bcd[2] >> 4) * 10 + (clock_state.bcd[2] & 0x0F);
+
+    clock_state.running = running;
+}
+
+
+/**
+ * @brief Advance the clock by 1 second; only the modified digits are redrawn and sent.
+ *      To be called every second (Ex: interrupt of the 1 Hz output of a RTC)
+ *      if VFD_CLOCK_TIMER is not set.
+ */
+void VFD_clockTick(void)
+{
+    if (!clock_state.running) {
+        return;
+    }
+
+    uint8_t carry  = VFD_clockIncrement(clock_state.bcd[0], 0x59);
+    uint8_t digits = carry & 0x03;
+    if (carry & VFD_CLOCK_CARRY) {
+        carry   = VFD_clockIncrement(clock_state.bcd[1], 0x59);
+        digits |= (carry & 0x03) << 2;
+        if (carry & VFD_CLOCK_CARRY) {
+            carry   = VFD_clockIncrement(clock_state.bcd[2], 0x23);
+            digits |= (carry & 0x03) << 4;
+        }
+    }
+
+    if (clock_state.blink) {
+        #if VFD_CLOCK_TIMER == 1
+        VFD_clockColon(true);
+        #else
+        VFD_clockColon(!clock_state.colon);
+        #endif
+    }
+    VFD_clockDraw(digits, false);
+    VFD_clockSend();
+}
+
+
+#if VFD_CLOCK_TIMER == 1
+/**
+ * @brief Advance the clock every F_CPU cycles, hide the blinking colon symbol
+ *      after half a second.
+ *      Called by the timer interrupt.
+ * @param period Actual CPU cycles between 2 interrupts: the rounding of the period of
+ *      the timer to its resolution (VFD_TIMER_FREQUENCY is approximate) is compensated,
+ *      the remainder of each second is carried to the next one.
+ * @note The accuracy of the clock is the one of the CPU clock (F_CPU).
+ */
+void VFD_clockInterrupt(uint32_t period)
+{
+    if (!clock_state.running) {
+        return;
+    }
+
+    uint32_t cycles = clock_state.cycles + period;
+    if (cycles >= F_CPU) {
+        clock_state.cycles = cycles - F_CPU;
+        VFD_clockTick();
+        return;
+    }
+    if (clock_state.blink && clock_state.cycles < F_CPU / 2 && cycles >= F_CPU / 2) {
+        VFD_clockColon(false);
+    }
+    clock_state.cycles = cycles;
+    // Grids not sent during a transmission of the main program
+    VFD_clockSend();
+}
+#endif
@@ -0,0 +1,58 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Accessors to the font tables stored in flash.
+ * This file is included at the end of the font files, in the namespace of the
+ * display variant (FONT and ICONS_FONT must be declared); it has no include guard.
+ */
+
+/**
+ * @brief Get the LSB part of a character.
+ * @param character Printable ASCII character present in the font (0x20..0x60).
+ */
+static inline uint8_t VFD_fontLSB(char character)
+{
+    return pgm_read_byte(&FONT[character - 0x20][1]);
+}
+
+/**
+ * @brief Get the MSB part of a character.
+ * @param character Printable ASCII character present in the font (0x20..0x60).
+ */
+static inline uint8_t VFD_fontMSB(char character)
+{
+    return pgm_read_byte(&FONT[character - 0x20][0]);
+}
+
+/**
+ * @brief Get the segments of a character: MSB part in the high byte, LSB part in the low byte.
+ * @param character Printable ASCII character present in the font (0x20..0x60).
+ */
+static inline uint16_t VFD_fontGlyph(char character)
+{
+    return (VFD_fontMSB(character) << 8) | VFD_fontLSB(character);
+}
+
+/**
+ * @brief Get the location of an icon (grid in the 4 LSB, segment in the 4 MSB).
+ * @param icon_font_index Index of the icon in the ICONS_FONT array.
+ */
+static inline uint8_t VFD_iconFont(uint8_t icon_font_index)
+{
+    return pgm_read_byte(&ICONS_FONT[icon_font_index]);
+}
+
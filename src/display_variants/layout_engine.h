@@ -0,0 +1,457 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Generic text functions of a display layout, generated at compile time from a
+ * descriptor of its character positions (see VFD_LayoutEngine).
+ */
+#ifndef LAYOUT_ENGINE_H
+#define LAYOUT_ENGINE_H
+
+// Part of the grid drawn by a character
+#define VFD_PART_GRID   0 // Both bytes of the grid
+#define VFD_PART_LSB    1 // LSB part of the grid (segments 1..8)
+#define VFD_PART_MSB    2 // MSB part of the grid (segments 9..16)
+
+// Part of the font glyph drawn by a character
+#define VFD_PLANE_GLYPH 0 // Both parts (MSB part in the high byte)
+#define VFD_PLANE_LSB   1 // LSB part of the glyph
+#define VFD_PLANE_MSB   2 // MSB part of the glyph
+
+/**
+ * Character position of a display.
+ */
+struct VFD_CharSlot
+{
+    // Grid number (starting from 1)
+    uint8_t  grid;
+    // Part of the grid: VFD_PART_GRID, VFD_PART_LSB or VFD_PART_MSB
+    uint8_t  part;
+    // Part of the glyph: VFD_PLANE_GLYPH, VFD_PLANE_LSB or VFD_PLANE_MSB
+    uint8_t  plane;
+    // Colon/decimal segments set with the character when requested
+    // (MSB part of the grid in the high byte, limited to the part of the character)
+    uint16_t colon;
+};
+
+
+/**
+ * Text functions of a layout, generated from its descriptor.
+ *
+ * The descriptor is only evaluated at compile time (no table in memory): the positions
+ * are grouped in runs of consecutive grids drawn the same way, and each run gets its own
+ * loop with the grid parts, font planes and colon segments as constants.
+ *
+ * @tparam Descriptor Class with:
+ *      - static constexpr uint8_t positions: number of character positions;
+ *      - static constexpr VFD_CharSlot slot(uint8_t position): character positions
+ *        (range 1..positions), sorted by grid, 1st character of a grid first;
+ *      - static uint8_t fontLSB(char), fontMSB(char): accessors to the font.
+ *
+ * Ex: "1 char per grid display" with a colon symbol on grid 3:
+ *      static constexpr VFD_CharSlot CHAR_SLOTS[] = {
+ *          {1, VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+ *          {2, VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+ *          {3, VFD_PART_GRID, VFD_PLANE_GLYPH, 0x0001},
+ *          ...
+ *      };
+ *      struct Descriptor {
+ *          static constexpr uint8_t positions = sizeof(CHAR_SLOTS) / sizeof(CHAR_SLOTS[0]);
+ *          static constexpr VFD_CharSlot slot(uint8_t position) { return CHAR_SLOTS[position - 1]; }
+ *          ...
+ *      };
+ *      struct Layout : VFD_LayoutEngine<Descriptor> { ... };
+ */
+template<class Descriptor>
+struct VFD_LayoutEngine : Descriptor
+{
+    typedef VFD_LayoutEngine Engine;
+
+    // Last grid of the layout
+    static constexpr uint8_t lastGrid(void)
+    {
+        return Descriptor::slot(Descriptor::positions).grid;
+    }
+
+    // First character position of a grid
+    static constexpr uint8_t firstPosition(uint8_t grid, uint8_t position = 1)
+    {
+        return (position > Descriptor::positions) ? 0
+            : (Descriptor::slot(position).grid == grid) ? position
+            : firstPosition(grid, position + 1);
+    }
+
+    // Number of characters of a grid
+    static constexpr uint8_t slotCount(uint8_t grid, uint8_t position = 1)
+    {
+        return (position > Descriptor::positions) ? 0
+            : (Descriptor::slot(position).grid == grid) + slotCount(grid, position + 1);
+    }
+
+    // Parts and planes of the characters of a grid, from the given position
+    static constexpr uint16_t shape(uint8_t grid, uint8_t position)
+    {
+        return ((position > Descriptor::positions) || (Descriptor::slot(position).grid != grid)) ? 0
+            : (Descriptor::slot(position).part << 2 | Descriptor::slot(position).plane | 0x10)
+              | (shape(grid, position + 1) << 5);
+    }
+
+    // Last grid of the run of grids drawn like the given one
+    static constexpr uint8_t runEnd(uint8_t grid)
+    {
+        return ((grid < lastGrid()) && (shape(grid + 1, firstPosition(grid + 1)) == shape(grid, firstPosition(grid))))
+            ? runEnd(grid + 1) : grid;
+    }
+
+    // Colon segments of a grid
+    static constexpr uint16_t gridColon(uint8_t grid, uint8_t position = 1)
+    {
+        return (position > Descriptor::positions) ? 0
+            : ((Descriptor::slot(position).grid == grid) ? Descriptor::slot(position).colon : 0)
+              | gridColon(grid, position + 1);
+    }
+
+    // Segments of a character for the given plane
+    template<uint8_t Plane>
+    static inline uint16_t fontPlane(char character)
+    {
+        return (Plane == VFD_PLANE_LSB) ? Descriptor::fontLSB(character)
+            : (Plane == VFD_PLANE_MSB) ? Descriptor::fontMSB(character)
+            : (Descriptor::fontMSB(character) << 8) | Descriptor::fontLSB(character);
+    }
+
+    // Draw segments on a part of the grid whose first byte is given
+    template<uint8_t Part>
+    static inline void drawPart(uint8_t *grid, uint16_t segments)
+    {
+        if (Part != VFD_PART_MSB) {
+            grid[0] = segments;
+        }
+        if (Part == VFD_PART_MSB) {
+            grid[1] = segments;
+        } else if (Part == VFD_PART_GRID) {
+            grid[1] = segments >> 8;
+        }
+    }
+
+    template<class Driver>
+    static void writeString(const char *string, bool colon_symbol);
+    template<class Driver>
+    static uint8_t writeChar(uint8_t position, char character, bool colon_symbol);
+    template<class Driver>
+    static uint8_t writeGlyph(uint8_t position, uint16_t glyph, bool colon_symbol);
+    static inline uint8_t gridPosition(uint8_t grid);
+    template<class Driver>
+    static uint16_t setColon(bool colon_symbol);
+};
+
+
+/**
+ * Characters of a grid, from the given position (see VFD_LayoutEngine::writeString()).
+ * @tparam Valid The 1st character is known to be present.
+ */
+template<class Engine, uint8_t Position, uint8_t Count, bool Valid>
+struct VFD_LayoutGridText
+{
+    static inline const char *write(const char *string, uint8_t *grid)
+    {
+        // Missing characters of the grid are blank
+        uint16_t segments = 0;
+        if (Valid || (*string > '\0')) {
+            segments = Engine::template fontPlane<Engine::slot(Position).plane>(*string);
+            string++;
+        }
+        Engine::template drawPart<Engine::slot(Position).part>(grid, segments);
+        return VFD_LayoutGridText<Engine, Position + 1, Count - 1, false>::write(string, grid);
+    }
+};
+
+template<class Engine, uint8_t Position, bool Valid>
+struct VFD_LayoutGridText<Engine, Position, 0, Valid>
+{
+    static inline const char *write(const char *string, uint8_t *grid)
+    {
+        (void)grid;
+        return string;
+    }
+};
+
+
+/**
+ * Character of a grid at a runtime index, from the given position
+ * (see VFD_LayoutEngine::writeGlyph()).
+ */
+template<class Engine, uint8_t Position, uint8_t Count>
+struct VFD_LayoutGridGlyph
+{
+    static constexpr uint8_t part  = Engine::slot(Position).part;
+    static constexpr uint8_t plane = Engine::slot(Position).plane;
+
+    static inline void write(uint8_t index, uint16_t glyph, uint8_t *grid)
+    {
+        if ((Count == 1) || (index == 0)) {
+            Engine::template drawPart<part>(
+                grid, (plane == VFD_PLANE_MSB) ? glyph >> 8 : (plane == VFD_PLANE_LSB) ? glyph & 0xFF : glyph);
+        } else {
+            VFD_LayoutGridGlyph<Engine, Position + 1, Count - 1>::write(index - 1, glyph, grid);
+        }
+    }
+};
+
+template<class Engine, uint8_t Position>
+struct VFD_LayoutGridGlyph<Engine, Position, 0>
+{
+    static inline void write(uint8_t index, uint16_t glyph, uint8_t *grid)
+    {
+        (void)index; (void)glyph; (void)grid;
+    }
+};
+
+
+/**
+ * Stand-in for a driver using all the grids of a layout.
+ */
+struct VFD_LayoutAllGrids
+{
+    static constexpr uint8_t grids = 0xFF;
+};
+
+
+/**
+ * Run of grids drawn the same way, from the given grid up to Engine::runEnd(Grid),
+ * followed by the next runs (only the grids of the driver are used).
+ */
+template<class Engine, class Driver, uint8_t Grid,
+         bool Valid = (Grid <= Engine::lastGrid()) && (Grid <= Driver::grids)>
+struct VFD_LayoutRun
+{
+    static constexpr uint8_t last     = (Engine::runEnd(Grid) < Driver::grids) ? Engine::runEnd(Grid) : Driver::grids;
+    static constexpr uint8_t first    = Engine::firstPosition(Grid);
+    static constexpr uint8_t count    = Engine::slotCount(Grid);
+    typedef VFD_LayoutRun<Engine, Driver, Engine::runEnd(Grid) + 1> Next;
+
+    static inline void writeString(const char *string)
+    {
+        while ((*string > '\0') && (Driver::gridCursor <= last)) {
+            uint8_t memory_addr = (Driver::gridCursor * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+            string = VFD_LayoutGridText<Engine, first, count, true>::write(string, &Driver::displayBuffer[memory_addr]);
+            Driver::gridCursor++;
+        }
+        Next::writeString(string);
+    }
+
+    static inline uint8_t writeGlyph(uint8_t position, uint16_t glyph)
+    {
+        if (position < first) {
+            // Position 0, or before the first run of the driver
+            return 0;
+        }
+        if (position >= first + (last - Grid + 1) * count) {
+            return Next::writeGlyph(position, glyph);
+        }
+        uint8_t index       = position - first;
+        uint8_t grid        = Grid + index / count;
+        uint8_t memory_addr = (grid * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+        VFD_LayoutGridGlyph<Engine, first, count>::write(index % count, glyph, &Driver::displayBuffer[memory_addr]);
+        return grid;
+    }
+
+    static inline uint8_t gridPosition(uint8_t grid)
+    {
+        return (grid <= last) ? first + (grid - Grid) * count : Next::gridPosition(grid);
+    }
+};
+
+template<class Engine, class Driver, uint8_t Grid>
+struct VFD_LayoutRun<Engine, Driver, Grid, false>
+{
+    static inline void writeString(const char *string) { (void)string; }
+    static inline uint8_t writeGlyph(uint8_t position, uint16_t glyph) { (void)position; (void)glyph; return 0; }
+    static inline uint8_t gridPosition(uint8_t grid) { (void)grid; return 0; }
+};
+
+
+/**
+ * Colon segments of the characters of a grid, from the given position.
+ */
+template<class Engine, class Driver, uint8_t Position, uint8_t Count>
+struct VFD_LayoutSlotColons
+{
+    static constexpr uint16_t colon = Engine::slot(Position).colon;
+
+    static inline void add(uint8_t position, uint8_t *grid)
+    {
+        if (colon && (position == Position)) {
+            grid[0] |= colon & 0xFF;
+            grid[1] |= colon >> 8;
+        }
+        VFD_LayoutSlotColons<Engine, Driver, Position + 1, Count - 1>::add(position, grid);
+    }
+};
+
+template<class Engine, class Driver, uint8_t Position>
+struct VFD_LayoutSlotColons<Engine, Driver, Position, 0>
+{
+    static inline void add(uint8_t position, uint8_t *grid) { (void)position; (void)grid; }
+};
+
+
+/**
+ * Colon segments of the grids, from the given grid (grids without colon generate no code).
+ */
+template<class Engine, class Driver, uint8_t Grid,
+         bool Valid = (Grid <= Engine::lastGrid()) && (Grid <= Driver::grids)>
+struct VFD_LayoutColons
+{
+    typedef VFD_LayoutColons<Engine, Driver, Grid + 1> Next;
+    static constexpr uint16_t colon = Engine::gridColon(Grid);
+    static constexpr uint8_t  memory_addr = (Grid * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+
+    // Add the colon segments to the grids first..end - 1
+    static inline void add(uint8_t first, uint8_t end)
+    {
+        if (colon && (first <= Grid) && (Grid < end)) {
+            Driver::displayBuffer[memory_addr]     |= colon & 0xFF;
+            Driver::displayBuffer[memory_addr + 1] |= colon >> 8;
+        }
+        Next::add(first, end);
+    }
+
+    // Add the colon segments of the character at the given position
+    static inline void addPosition(uint8_t position)
+    {
+        VFD_LayoutSlotColons<Engine, Driver, Engine::firstPosition(Grid), Engine::slotCount(Grid)>::add(
+            position, &Driver::displayBuffer[memory_addr]);
+        Next::addPosition(position);
+    }
+
+    // Show or hide the colon segments, return the mask of the modified grids
+    static inline uint16_t set(bool colon_symbol)
+    {
+        if (!colon) {
+            return Next::set(colon_symbol);
+        }
+        if (colon_symbol) {
+            Driver::displayBuffer[memory_addr]     |= colon & 0xFF;
+            Driver::displayBuffer[memory_addr + 1] |= colon >> 8;
+        }else{
+            Driver::displayBuffer[memory_addr]     &= ~(colon & 0xFF);
+            Driver::displayBuffer[memory_addr + 1] &= ~(colon >> 8);
+        }
+        return (1 << (Grid - 1)) | Next::set(colon_symbol);
+    }
+};
+
+template<class Engine, class Driver, uint8_t Grid>
+struct VFD_LayoutColons<Engine, Driver, Grid, false>
+{
+    static inline void add(uint8_t first, uint8_t end) { (void)first; (void)end; }
+    static inline void addPosition(uint8_t position) { (void)position; }
+    static inline uint16_t set(bool colon_symbol) { (void)colon_symbol; return 0; }
+};
+
+
+/**
+ * @brief Write a string of characters present in the font, from the grid cursor.
+ *      The characters are placed according to the descriptor of the layout;
+ *      the missing characters of the last grid are blank.
+ * @param string String must be null terminated '\0'. Grid cursor is auto-incremented.
+ * @param colon_symbol Boolean set to true to display the colon segments of the written grids.
+ * @warning The string MUST be null terminated.
+ */
+template<class Descriptor>
+template<class Driver>
+void VFD_LayoutEngine<Descriptor>::writeString(const char *string, bool colon_symbol)
+{
+    uint8_t first_grid = Driver::gridCursor;
+
+    VFD_LayoutRun<Engine, Driver, 1>::writeString(string);
+
+    if (colon_symbol) {
+        VFD_LayoutColons<Engine, Driver, 1>::add(first_grid, Driver::gridCursor);
+    }
+
+    // Send the modified grids (icons are merged here)
+    Driver::flush();
+}
+
+
+/**
+ * @brief Draw a character at the given character position in displayBuffer,
+ *      without modifying the other characters of the grid.
+ *      Nothing is sent to the controller.
+ * @param position Character position (range 1..Descriptor::positions).
+ * @param character Character present in the font.
+ * @param colon_symbol Boolean set to true to keep the colon segments of the character.
+ * @return Grid number of the character (0 if the position is not on the display).
+ * @see writeString()
+ */
+template<class Descriptor>
+template<class Driver>
+uint8_t VFD_LayoutEngine<Descriptor>::writeChar(uint8_t position, char character, bool colon_symbol)
+{
+    return writeGlyph<Driver>(position, fontPlane<VFD_PLANE_GLYPH>(character), colon_symbol);
+}
+
+
+/**
+ * @brief Draw the segments of an encoded character at the given character position
+ *      in displayBuffer, without modifying the other characters of the grid.
+ *      Nothing is sent to the controller.
+ * @param position Character position (range 1..Descriptor::positions).
+ * @param glyph Segments of the character: MSB part in the high byte, LSB part in the low byte;
+ *      only the plane of the position is drawn.
+ * @param colon_symbol Boolean set to true to keep the colon segments of the character.
+ * @return Grid number of the character (0 if the position is not on the display).
+ */
+template<class Descriptor>
+template<class Driver>
+uint8_t VFD_LayoutEngine<Descriptor>::writeGlyph(uint8_t position, uint16_t glyph, bool colon_symbol)
+{
+    uint8_t grid = VFD_LayoutRun<Engine, Driver, 1>::writeGlyph(position, glyph);
+
+    if (colon_symbol && grid) {
+        VFD_LayoutColons<Engine, Driver, 1>::addPosition(position);
+    }
+    return grid;
+}
+
+
+/**
+ * @brief Get the character position of the first character of a grid.
+ * @param grid Grid number (range 1..lastGrid()).
+ */
+template<class Descriptor>
+inline uint8_t VFD_LayoutEngine<Descriptor>::gridPosition(uint8_t grid)
+{
+    return VFD_LayoutRun<Engine, VFD_LayoutAllGrids, 1>::gridPosition(grid);
+}
+
+
+/**
+ * @brief Show or hide the colon segments in displayBuffer, without modifying the characters.
+ *      Nothing is sent to the controller.
+ * @param colon_symbol Boolean set to true to display the colon segments.
+ * @return Mask of the modified grids (bit 0: grid 1).
+ */
+template<class Descriptor>
+template<class Driver>
+uint16_t VFD_LayoutEngine<Descriptor>::setColon(bool colon_symbol)
+{
+    return VFD_LayoutColons<Engine, Driver, 1>::set(colon_symbol);
+}
+
+#endif
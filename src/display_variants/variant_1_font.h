@@ -14,10 +14,18 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
-#ifndef FONT_H
-#define FONT_H
-
+// Outside of the include guard: PT6312.h (that includes the font of the selected
+// variant) is always processed first
 #include "PT6312.h"
+
+#ifndef VARIANT_1_FONT_H
+#define VARIANT_1_FONT_H
+
+#include "spinner_table.h"
+#include "glyph.h"
+
+namespace VFD_Variant1 {
+
 // Segment numbering for ET16312n VFD driver
 //         8
 //     ---------
@@ -32,73 +40,87 @@
 //         2
 //
 // ASCII codes starting to 0x20 offset (space character)
-#define VFD_COLON_SYMBOL_BIT    1  // Segment number (starting from 1)
-const uint8_t FONT[65][2] = {
-    {0b00000000, 0b00000000}, // space 0x20
-    {0b00000000, 0b00000000}, // ! N/A
-    {0b00000000, 0b00000000}, // " N/A
-    {0b00000000, 0b00000000}, // # N/A
-    {0b00000000, 0b00000000}, // $ N/A
-    {0b00000000, 0b00000000}, // % N/A
-    {0b00000000, 0b00000000}, // & N/A
-    {0b00000000, 0b00000000}, // ' N/A
-    {0b00000000, 0b10100110}, // ( (bits 8, 6, 3, 2)
-    {0b00000000, 0b11001010}, // ) (bits 8, 7, 4, 2)
-    {0b00000000, 0b00000000}, // * N/A
-    {0b00000000, 0b00000000}, // + N/A
-    {0b00000000, 0b00000000}, // , N/A
-    {0b00000000, 0b00010000}, // - (bit 5)
-    {0b00000000, 0b00000000}, // . N/A
-    {0b00000000, 0b00000000}, // / N/A
-    {0b00000000, 0b11101110}, // 0 (bits 8, 7, 6, 4, 3, 2)
-    {0b00000000, 0b01001000}, // 1 (bits 7, 4)
-    {0b00000000, 0b11010110}, // 2 (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b11011010}, // 3 (bits 8, 7, 5, 4, 2)
-    {0b00000000, 0b01111000}, // 4 (bits 7, 6, 5, 4)
-    {0b00000000, 0b10111010}, // 5 (bits 8, 6, 5, 4, 2)
-    {0b00000000, 0b10111110}, // 6 (bits 8, 6, 5, 4, 3, 2)
-    {0b00000000, 0b11001000}, // 7 (bits 8, 7, 4)
-    {0b00000000, 0b11111110}, // 8 (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b11111010}, // 9 (bits 8, 7, 6, 5, 4, 2)
-    {0b00000000, 0b00000001}, // : (bit 1) available before 5-th digit only
-    {0b00000000, 0b00000000}, // ; N/A
-    {0b00000000, 0b00000000}, // < N/A
-    {0b00000000, 0b00010010}, // = (bits 5, 2)
-    {0b00000000, 0b00000000}, // > N/A
-    {0b00000000, 0b00000000}, // ? N/A
-    {0b00000000, 0b00000000}, // @ N/A
-    {0b00000000, 0b11111100}, // A (bits 8, 7, 6, 5, 4, 3)
-    {0b00000000, 0b11111110}, // B (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b10100110}, // C (bits 8, 6, 3, 2)
-    {0b00000000, 0b11101110}, // D (bits 8, 7, 6, 4, 3, 2)
-    {0b00000000, 0b10110110}, // E (bits 8, 6, 5, 3, 2)
-    {0b00000000, 0b10110100}, // F (bits 8, 6, 5, 3)
-    {0b00000000, 0b10111110}, // G (bits 8, 6, 5, 4, 3, 2)
-    {0b00000000, 0b01111100}, // H (bits 7, 6, 5, 4, 3)
-    {0b00000000, 0b01001000}, // I (bits 7, 4)
-    {0b00000000, 0b01001010}, // J (bits 7, 4, 2)
-    {0b00000000, 0b00000000}, // K N/A
-    {0b00000000, 0b00100110}, // L (bits 6, 3, 2)
-    {0b00000000, 0b11101100}, // M (bits 8, 7, 6, 4, 3)
-    {0b00000000, 0b11101100}, // N (bits 8, 7, 6, 4, 3)
-    {0b00000000, 0b00011110}, // O (bits 5, 4, 3, 2)
-    {0b00000000, 0b11100100}, // P (bits 8, 7, 6, 3)
-    {0b00000000, 0b00011110}, // Q (bits 5, 4, 3, 2)
-    {0b00000000, 0b11010110}, // R (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b10111010}, // S (bits 8, 6, 5, 4, 2)
-    {0b00000000, 0b11001000}, // T (bits 8, 7, 4)
-    {0b00000000, 0b01101110}, // U (bits 7, 6, 4, 3, 2)
-    {0b00000000, 0b01101110}, // V (bits 7, 6, 4, 3, 2)
-    {0b00000000, 0b01101110}, // W (bits 7, 6, 4, 3, 2)
-    {0b00000000, 0b11111110}, // X (bits 8, 7, 6, 5, 4, 3, 2)
-    {0b00000000, 0b01111000}, // Y (bits 7, 6, 5, 4)
-    {0b00000000, 0b11010110}, // Z (bits 8, 7, 5, 3, 2)
-    {0b00000000, 0b10100110}, // [ (bits 8, 6, 3, 2)
-    {0b00000000, 0b00000001}, // \ (bit 1) available for 1st digit only
-    {0b00000000, 0b11001010}, // ] (bits 8, 7, 4, 2)
-    {0b00000000, 0b00000000}, // ^ N/A
-    {0b00000000, 0b00000010}, // _ (bit 2)
+static constexpr uint8_t colonSymbolBit = 1;  // Segment number (starting from 1)
+// Bit of the colon symbol in the LSB/MSB part of a grid (0 if it's in the other part)
+static constexpr uint8_t colonSymbolLSB = (colonSymbolBit < 9) ? (1 << (colonSymbolBit - 1)) : 0;
+static constexpr uint8_t colonSymbolMSB = (colonSymbolBit > 8) ? (1 << (colonSymbolBit - 9)) : 0;
+static constexpr uint8_t spinnerBytes   = 1;  // Bytes used by the busy spinning circle
+// Busy spinning circle: 70 refreshes per frame, fading segments at 1/2, 1/5, 1/12,
+// segments in order of display (MSB part of the grid)
+typedef VFD_SpinnerTable<70, VFD_SpinnerDuty<2, 5, 12>, 11, 12, 13, 14, 15, 16> SpinnerFrames;
+// Tables are stored in flash (PROGMEM) and must be read with the accessors of font_access.h.
+// They are defined once in variant_1_font.cpp (VFD_VARIANT_1_FONT_DEFINITIONS) and declared elsewhere.
+extern const uint8_t FONT[65][2] PROGMEM;
+extern const uint8_t ICONS_FONT[] PROGMEM;
+
+#ifdef VFD_VARIANT_1_FONT_DEFINITIONS
+const uint8_t FONT[65][2] PROGMEM = {
+    VFD_GLYPH(), // space 0x20
+    VFD_GLYPH(), // ! N/A
+    VFD_GLYPH(), // " N/A
+    VFD_GLYPH(), // # N/A
+    VFD_GLYPH(), // $ N/A
+    VFD_GLYPH(), // % N/A
+    VFD_GLYPH(), // & N/A
+    VFD_GLYPH(), // ' N/A
+    VFD_GLYPH(8, 6, 3, 2), // (
+    VFD_GLYPH(8, 7, 4, 2), // )
+    VFD_GLYPH(), // * N/A
+    VFD_GLYPH(), // + N/A
+    VFD_GLYPH(), // , N/A
+    VFD_GLYPH(5), // -
+    VFD_GLYPH(), // . N/A
+    VFD_GLYPH(), // / N/A
+    VFD_GLYPH(8, 7, 6, 4, 3, 2), // 0
+    VFD_GLYPH(7, 4), // 1
+    VFD_GLYPH(8, 7, 5, 3, 2), // 2
+    VFD_GLYPH(8, 7, 5, 4, 2), // 3
+    VFD_GLYPH(7, 6, 5, 4), // 4
+    VFD_GLYPH(8, 6, 5, 4, 2), // 5
+    VFD_GLYPH(8, 6, 5, 4, 3, 2), // 6
+    VFD_GLYPH(8, 7, 4), // 7
+    VFD_GLYPH(8, 7, 6, 5, 4, 3, 2), // 8
+    VFD_GLYPH(8, 7, 6, 5, 4, 2), // 9
+    VFD_GLYPH(1), // : available before 5-th digit only
+    VFD_GLYPH(), // ; N/A
+    VFD_GLYPH(), // < N/A
+    VFD_GLYPH(5, 2), // =
+    VFD_GLYPH(), // > N/A
+    VFD_GLYPH(), // ? N/A
+    VFD_GLYPH(), // @ N/A
+    VFD_GLYPH(8, 7, 6, 5, 4, 3), // A
+    VFD_GLYPH(8, 7, 6, 5, 4, 3, 2), // B
+    VFD_GLYPH(8, 6, 3, 2), // C
+    VFD_GLYPH(8, 7, 6, 4, 3, 2), // D
+    VFD_GLYPH(8, 6, 5, 3, 2), // E
+    VFD_GLYPH(8, 6, 5, 3), // F
+    VFD_GLYPH(8, 6, 5, 4, 3, 2), // G
+    VFD_GLYPH(7, 6, 5, 4, 3), // H
+    VFD_GLYPH(7, 4), // I
+    VFD_GLYPH(7, 4, 2), // J
+    VFD_GLYPH(), // K N/A
+    VFD_GLYPH(6, 3, 2), // L
+    VFD_GLYPH(8, 7, 6, 4, 3), // M
+    VFD_GLYPH(8, 7, 6, 4, 3), // N
+    VFD_GLYPH(5, 4, 3, 2), // O
+    VFD_GLYPH(8, 7, 6, 3), // P
+    VFD_GLYPH(5, 4, 3, 2), // Q
+    VFD_GLYPH(8, 7, 5, 3, 2), // R
+    VFD_GLYPH(8, 6, 5, 4, 2), // S
+    VFD_GLYPH(8, 7, 4), // T
+    VFD_GLYPH(7, 6, 4, 3, 2), // U
+    VFD_GLYPH(7, 6, 4, 3, 2), // V
+    VFD_GLYPH(7, 6, 4, 3, 2), // W
+    VFD_GLYPH(8, 7, 6, 5, 4, 3, 2), // X
+    VFD_GLYPH(7, 6, 5, 4), // Y
+    VFD_GLYPH(8, 7, 5, 3, 2), // Z
+    VFD_GLYPH(8, 6, 3, 2), // [
+    VFD_GLYPH(1), // \ available for 1st digit only
+    VFD_GLYPH(8, 7, 4, 2), // ]
+    VFD_GLYPH(), // ^ N/A
+    VFD_GLYPH(2), // _
 };
+#endif
 
 // Shortcuts refering to the indexes in the table ICONS_FONT
 #define ICON_PBC          0
@@ -120,7 +142,8 @@ const uint8_t FONT[65][2] = {
 // 2 sections of 4 bits in 1 byte:
 // LSB: grid number starting from 0
 // MSB: segment number starting from 0
-const uint8_t ICONS_FONT[] = {
+#ifdef VFD_VARIANT_1_FONT_DEFINITIONS
+const uint8_t ICONS_FONT[] PROGMEM = {
     0b10000000, // Index 0:  Grid 0; 9;  PBC
     0b10010000, // Index 1:  Grid 0; 10; DVD
     0b00000001, // Index 2:  Grid 1; 1;  Play
@@ -137,5 +160,10 @@ const uint8_t ICONS_FONT[] = {
     0b00000011, // Index 13: Grid 3; 1;  Colon
     0b10000011, // Index 14: Grid 3; 9;  MP3
 };
+#endif
+
+#include "font_access.h"
+
+} // namespace VFD_Variant1
 
 #endif
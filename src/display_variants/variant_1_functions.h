@@ -0,0 +1,121 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* This file is dedicated for a "2 chars per grid display".
+ * Layout used as template parameter of the PT6312 driver (see PT6312_driver.h).
+ */
+#ifndef VARIANT_1_FUNCTIONS_H
+#define VARIANT_1_FUNCTIONS_H
+
+#include "display_variants/variant_1_font.h"
+#include "display_variants/layout_engine.h"
+
+namespace VFD_Variant1 {
+
+/**
+ * Character positions of a "2 chars per grid display":
+ *      Positions 1 and 2: grids 1 and 2 (1 char per grid, LSB part only: the MSB part
+ *      is left to the icons and the busy spinning circle).
+ *      Positions 3 and 4: grid 3, positions 5 and 6: grid 4
+ *      (1st char in the MSB part, 2nd char in the LSB part, LSB part of the font only).
+ *      The colon symbol is displayed between chars 4 and 5 (grid 4).
+ */
+static constexpr VFD_CharSlot CHAR_SLOTS[] = {
+    {1, VFD_PART_LSB, VFD_PLANE_LSB, 0},
+    {2, VFD_PART_LSB, VFD_PLANE_LSB, 0},
+    {3, VFD_PART_MSB, VFD_PLANE_LSB, 0},
+    {3, VFD_PART_LSB, VFD_PLANE_LSB, 0},
+    {4, VFD_PART_MSB, VFD_PLANE_LSB, colonSymbolMSB << 8},
+    {4, VFD_PART_LSB, VFD_PLANE_LSB, colonSymbolLSB},
+};
+
+/**
+ * Descriptor of the layout, see VFD_LayoutEngine.
+ */
+struct Descriptor
+{
+    static constexpr uint8_t positions = sizeof(CHAR_SLOTS) / sizeof(CHAR_SLOTS[0]);
+    static constexpr VFD_CharSlot slot(uint8_t position) { return CHAR_SLOTS[position - 1]; }
+
+    static inline uint8_t fontLSB(char character) { return VFD_fontLSB(character); }
+    static inline uint8_t fontMSB(char character) { return VFD_fontMSB(character); }
+};
+
+/**
+ * Layout of a "2 chars per grid display".
+ * The text functions (writeString(), writeChar(), writeGlyph(), gridPosition(), setColon())
+ * are generated from the descriptor.
+ */
+struct Layout : VFD_LayoutEngine<Descriptor>
+{
+    typedef VFD_Variant1::SpinnerFrames SpinnerFrames;
+    // Encoded character (see fontGlyph()): only the LSB part of the font is used
+    typedef uint8_t Glyph;
+    // Bytes used by the busy spinning circle
+    static constexpr uint8_t spinnerBytes = VFD_Variant1::spinnerBytes;
+    // Number of glyphs in the font
+    static constexpr uint8_t fontSize     = sizeof(FONT) / sizeof(FONT[0]);
+    // The '.' character of the font is displayed (no decimal point segment)
+    static constexpr bool    decimalPoint = false;
+
+    static inline Glyph fontGlyph(char character) { return VFD_fontLSB(character); }
+    static inline uint8_t iconFont(uint8_t icon_font_index) { return VFD_iconFont(icon_font_index); }
+
+    template<class Driver>
+    static uint8_t busySpinningCircleFrame(uint8_t address, uint8_t frame_number, uint8_t loop_number);
+};
+
+
+/**
+ * @brief Draw a frame of the busy spinning circle that uses 1 byte (half grid)
+ *      in animationBuffer (merged with the text on flush).
+ * @param address Memory address on the controller where the animation frames must be set
+ *      (range 0..Driver::displayMemory - 1).
+ * @param frame_number Current frame to display (Value range 1..6 (6 segments)).
+ * @param loop_number Number of refreshes of the frame (Value range 0..69);
+ *      used to set the duty cycle of fading frames.
+ * @return Memory address of the first modified byte (spinnerBytes are modified).
+ * @note
+ *      The animation takes place on the current position set by the value of cursor.
+ *      The concerned segments for this display are localized on the grid 1.
+ *      The segments are: 11, 12, 13, 14, 15, 16 (it's the MSB part of the grid).
+ *
+ *      A same frame is refreshed 70 times before moving to the next.
+ *      An entire loop is made in 420 calls (6 frames * 70 calls each).
+ *      It's up to you to adjust the total time of a loop to 1 second by setting up
+ *      a delay (VFD_BUSY_DELAY) after a call (should be ~2.35ms).
+ *      The number of refreshes for a frame is stored in loop_number.
+ *
+ *      A frame is composed of segments displayed at different duty cycles (1, 1/2, 1/5, 1/12)
+ *      to obtain a fading effect for the segments behind the main segment.
+ *      Frames are precomputed in flash (see SpinnerFrames in variant_1_font.h).
+ *      Ex: For 16th main segment:
+ *          15, 14, 13 are displayed, from the most marked to the darkest;
+ *          the others are not displayed (12, 11).
+ * @see VFD_busySpinningCircle(), VFD_spinnerStart()
+ */
+template<class Driver>
+uint8_t Layout::busySpinningCircleFrame(uint8_t address, uint8_t frame_number, uint8_t loop_number)
+{
+    // Segments 11..16 are in the MSB part of the grid
+    Driver::animationBuffer[address] = SpinnerFrames::word(frame_number, loop_number) >> 8;
+    return address;
+}
+
+} // namespace VFD_Variant1
+
+#endif
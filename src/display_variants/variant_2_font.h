@@ -18,10 +18,18 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
-#ifndef FONT_H
-#define FONT_H
-
+// Outside of the include guard: PT6312.h (that includes the font of the selected
+// variant) is always processed first
 #include "PT6312.h"
+
+#ifndef VARIANT_2_FONT_H
+#define VARIANT_2_FONT_H
+
+#include "spinner_table.h"
+#include "glyph.h"
+
+namespace VFD_Variant2 {
+
 // Segment numbering for ET16312n VFD driver
 //         7
 //     ---------
@@ -36,76 +44,90 @@
 //         11
 //
 // ASCII codes starting to 0x20 offset (space character)
-#define VFD_COLON_SYMBOL_BIT    10
-const uint8_t FONT[65][2] = {
-    {0b00000000, 0b00000000}, // space 0x20
-    {0b00000000, 0b00000000}, // ! N/A
-    {0b00000000, 0b00000000}, // " N/A
-    {0b00000000, 0b00000000}, // # N/A
-    {0b11000101, 0b01100011}, // $ (bits 16, 15, 11, 9, 7, 6, 2, 1)
-    {0b00000000, 0b00000000}, // % N/A
-    {0b00000000, 0b00000000}, // & N/A
-    {0b00000000, 0b00000000}, // ' N/A
-    {0b00001001, 0b00001000}, // ( (bits 12, 9, 4)
-    {0b00010001, 0b00010000}, // ) (bits 13, 9, 5)
-    {0b10011001, 0b00111001}, // * (bits 16, 13, 12, 9, 6, 5, 4, 1)
-    {0b10000001, 0b00100001}, // + (bits 16, 9, 6, 1)
-    {0b00000000, 0b00000000}, // , N/A
-    {0b10000001, 0b00000001}, // - (bits 16, 9, 1)
-    {0b00000001, 0b00000000}, // . (bit 9)
-    {0b00010001, 0b00001000}, // / (bits 13, 9, 4)
-    {0b01110100, 0b01001110}, // 0 (bits 15, 14, 13, 11, 7, 4, 3, 2)
-    {0b01000000, 0b00001100}, // 1 (bits 15, 4, 3)
-    {0b10100101, 0b01000101}, // 2 (bits 16, 14, 11, 9, 7, 3, 1)
-    {0b11000101, 0b01000101}, // 3 (bits 16, 15, 11, 9, 7, 3, 1)
-    {0b11000001, 0b00000111}, // 4 (bits 16, 15, 9, 3, 2, 1)
-    {0b11000101, 0b01000011}, // 5 (bits 16, 15, 11, 9, 7, 2, 1)
-    {0b11100101, 0b01000011}, // 6 (bits 16, 15, 14, 11, 9, 7, 2, 1)
-    {0b00010001, 0b01001000}, // 7 (bits 13, 9, 7, 4)
-    {0b11100101, 0b01000111}, // 8 (bits 16, 15, 14, 11, 9, 7, 3, 2, 1)
-    {0b11000101, 0b01000111}, // 9 (bits 16, 15, 11, 9, 7, 3, 2, 1)
-    {0b00000010, 0b00000000}, // : (bit 10)  available for 3-th and 5-th digits only
-    {0b00000000, 0b00000000}, // ; N/A
-    {0b00001000, 0b00001000}, // < (bits 12, 4)
-    {0b10000101, 0b00000001}, // = (bits 16, 11, 9, 1)
-    {0b00010000, 0b00010000}, // > (bits 13, 5)
-    {0b00000000, 0b00000000}, // ? N/A
-    {0b00000000, 0b00000000}, // @ N/A
-    {0b11100001, 0b01000111}, // A (bits 16, 15, 14, 9, 7, 3, 2, 1)
-    {0b01000101, 0b01100101}, // B (bits 15, 11, 9, 7, 6, 3, 1)
-    {0b00100100, 0b01000010}, // C (bits 14, 11, 7, 2)
-    {0b01000101, 0b01100100}, // D (bits 15, 11, 9, 7, 6, 3)
-    {0b10100101, 0b01000011}, // E (bits 16, 14, 11, 9, 7, 2, 1)
-    {0b10100001, 0b01000010}, // F (bits 16, 14, 9, 7, 2)
-    {0b01100100, 0b01000011}, // G (bits 15, 14, 11, 7, 2, 1)
-    {0b11100001, 0b00000111}, // H (bits 16, 15, 14, 9, 3, 2, 1)
-    {0b00000001, 0b00100000}, // I (bits 9, 6)
-    {0b01100100, 0b00000100}, // J (bits 15, 14, 11, 3)
-    {0b10101001, 0b00001010}, // K (bits 16, 14, 12, 9, 4, 2)
-    {0b00100100, 0b00000010}, // L (bits 14, 11, 2)
-    {0b01100000, 0b00011110}, // M (bits 15, 14, 5, 4, 3, 2)
-    {0b01101001, 0b00010110}, // N (bits 15, 14, 12, 9, 5, 3, 2)
-    {0b01100100, 0b01000110}, // O (bits 15, 14, 11, 7, 3, 2)
-    {0b10100001, 0b01000111}, // P (bits 16, 14, 9, 7, 3, 2, 1)
-    {0b01101100, 0b01000110}, // Q (bits 15, 14, 12, 11, 7, 3, 2)
-    {0b10101001, 0b01000111}, // R (bits 16, 14, 12, 9, 7, 3, 2, 1)
-    {0b11000101, 0b01000011}, // S (bits 16, 15, 11, 9, 7, 2, 1)
-    {0b00000001, 0b01100000}, // T (bits 9, 7, 6)
-    {0b01100100, 0b00000110}, // U (bits 15, 14, 11, 3, 2)
-    {0b00110000, 0b00001010}, // V (bits 14, 13, 4, 2)
-    {0b01111001, 0b00000110}, // W (bits 15, 14, 13, 12, 9, 3, 2)
-    {0b00011001, 0b00011000}, // X (bits 13, 12, 9, 5, 4)
-    {0b00010001, 0b00011000}, // Y (bits 13, 9, 5, 4)
-    {0b00010101, 0b01001000}, // Z (bits 13, 11, 9, 7, 4)
-    {0b00100100, 0b01000010}, // [ (bits 14, 11, 7, 2)
-    {0b00001001, 0b00010000}, // \ (bits 12, 9, 5)
-    {0b01000100, 0b01000100}, // ] (bits 15, 11, 7, 3)
-    {0b00000000, 0b00000000}, // ^ N/A
-    {0b00000100, 0b00000000}, // _ (bits 11)
+static constexpr uint8_t colonSymbolBit = 10; // Segment number (starting from 1)
+// Bit of the colon symbol in the LSB/MSB part of a grid (0 if it's in the other part)
+static constexpr uint8_t colonSymbolLSB = (colonSymbolBit < 9) ? (1 << (colonSymbolBit - 1)) : 0;
+static constexpr uint8_t colonSymbolMSB = (colonSymbolBit > 8) ? (1 << (colonSymbolBit - 9)) : 0;
+static constexpr uint8_t spinnerBytes   = 2;  // Bytes used by the busy spinning circle
+// Busy spinning circle: 70 refreshes per frame, fading segments at 1/2, 1/5, 1/12,
+// segments in order of display
+typedef VFD_SpinnerTable<70, VFD_SpinnerDuty<2, 5, 12>, 4, 1, 12, 13, 16, 5> SpinnerFrames;
+// Tables are stored in flash (PROGMEM) and must be read with the accessors of font_access.h.
+// They are defined once in variant_2_font.cpp (VFD_VARIANT_2_FONT_DEFINITIONS) and declared elsewhere.
+extern const uint8_t FONT[65][2] PROGMEM;
+extern const uint8_t ICONS_FONT[] PROGMEM;
+
+#ifdef VFD_VARIANT_2_FONT_DEFINITIONS
+const uint8_t FONT[65][2] PROGMEM = {
+    VFD_GLYPH(), // space 0x20
+    VFD_GLYPH(), // ! N/A
+    VFD_GLYPH(), // " N/A
+    VFD_GLYPH(), // # N/A
+    VFD_GLYPH(16, 15, 11, 9, 7, 6, 2, 1), // $
+    VFD_GLYPH(), // % N/A
+    VFD_GLYPH(), // & N/A
+    VFD_GLYPH(), // ' N/A
+    VFD_GLYPH(12, 9, 4), // (
+    VFD_GLYPH(13, 9, 5), // )
+    VFD_GLYPH(16, 13, 12, 9, 6, 5, 4, 1), // *
+    VFD_GLYPH(16, 9, 6, 1), // +
+    VFD_GLYPH(), // , N/A
+    VFD_GLYPH(16, 9, 1), // -
+    VFD_GLYPH(9), // .
+    VFD_GLYPH(13, 9, 4), // /
+    VFD_GLYPH(15, 14, 13, 11, 7, 4, 3, 2), // 0
+    VFD_GLYPH(15, 4, 3), // 1
+    VFD_GLYPH(16, 14, 11, 9, 7, 3, 1), // 2
+    VFD_GLYPH(16, 15, 11, 9, 7, 3, 1), // 3
+    VFD_GLYPH(16, 15, 9, 3, 2, 1), // 4
+    VFD_GLYPH(16, 15, 11, 9, 7, 2, 1), // 5
+    VFD_GLYPH(16, 15, 14, 11, 9, 7, 2, 1), // 6
+    VFD_GLYPH(13, 9, 7, 4), // 7
+    VFD_GLYPH(16, 15, 14, 11, 9, 7, 3, 2, 1), // 8
+    VFD_GLYPH(16, 15, 11, 9, 7, 3, 2, 1), // 9
+    VFD_GLYPH(10), // : available for 3-th and 5-th digits only
+    VFD_GLYPH(), // ; N/A
+    VFD_GLYPH(12, 4), // <
+    VFD_GLYPH(16, 11, 9, 1), // =
+    VFD_GLYPH(13, 5), // >
+    VFD_GLYPH(), // ? N/A
+    VFD_GLYPH(), // @ N/A
+    VFD_GLYPH(16, 15, 14, 9, 7, 3, 2, 1), // A
+    VFD_GLYPH(15, 11, 9, 7, 6, 3, 1), // B
+    VFD_GLYPH(14, 11, 7, 2), // C
+    VFD_GLYPH(15, 11, 9, 7, 6, 3), // D
+    VFD_GLYPH(16, 14, 11, 9, 7, 2, 1), // E
+    VFD_GLYPH(16, 14, 9, 7, 2), // F
+    VFD_GLYPH(15, 14, 11, 7, 2, 1), // G
+    VFD_GLYPH(16, 15, 14, 9, 3, 2, 1), // H
+    VFD_GLYPH(9, 6), // I
+    VFD_GLYPH(15, 14, 11, 3), // J
+    VFD_GLYPH(16, 14, 12, 9, 4, 2), // K
+    VFD_GLYPH(14, 11, 2), // L
+    VFD_GLYPH(15, 14, 5, 4, 3, 2), // M
+    VFD_GLYPH(15, 14, 12, 9, 5, 3, 2), // N
+    VFD_GLYPH(15, 14, 11, 7, 3, 2), // O
+    VFD_GLYPH(16, 14, 9, 7, 3, 2, 1), // P
+    VFD_GLYPH(15, 14, 12, 11, 7, 3, 2), // Q
+    VFD_GLYPH(16, 14, 12, 9, 7, 3, 2, 1), // R
+    VFD_GLYPH(16, 15, 11, 9, 7, 2, 1), // S
+    VFD_GLYPH(9, 7, 6), // T
+    VFD_GLYPH(15, 14, 11, 3, 2), // U
+    VFD_GLYPH(14, 13, 4, 2), // V
+    VFD_GLYPH(15, 14, 13, 12, 9, 3, 2), // W
+    VFD_GLYPH(13, 12, 9, 5, 4), // X
+    VFD_GLYPH(13, 9, 5, 4), // Y
+    VFD_GLYPH(13, 11, 9, 7, 4), // Z
+    VFD_GLYPH(14, 11, 7, 2), // [
+    VFD_GLYPH(12, 9, 5), // \ backslash
+    VFD_GLYPH(15, 11, 7, 3), // ]
+    VFD_GLYPH(), // ^ N/A
+    VFD_GLYPH(11), // _
 
     //Special non-standard symbols
-    {0b10000001, 0b01000111}  // degree (bits 16, 9, 7, 3, 2, 1) (index 64)
+    VFD_GLYPH(16, 9, 7, 3, 2, 1) // degree (index 64)
 };
+#endif
 
 
 // Shortcuts refering to the indexes in the table ICONS_FONT
@@ -114,9 +136,15 @@ const uint8_t FONT[65][2] = {
 
 // LSB: grid number starting from 0
 // MSB: segment number starting from 0
-const uint8_t ICONS_FONT[] = {
+#ifdef VFD_VARIANT_2_FONT_DEFINITIONS
+const uint8_t ICONS_FONT[] PROGMEM = {
     0b10010011, // Index 0:  Grid 3; 9;  Colon
     0b00010101, // Index 13: Grid 5; 9;  Colon
 };
+#endif
+
+#include "font_access.h"
+
+} // namespace VFD_Variant2
 
 #endif
@@ -0,0 +1,131 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * Based on the work of 2017 Istrate Liviu - <istrateliviu24@yahoo.com>
+ * Itself inspired by http://www.instructables.com/id/A-DVD-Player-Hack/
+ * Also inspired from https://os.mbed.com/users/wim/code/mbed_PT6312/
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* This file is dedicated for a "1 char per grid display".
+ * Layout used as template parameter of the PT6312 driver (see PT6312_driver.h).
+ */
+#ifndef VARIANT_2_FUNCTIONS_H
+#define VARIANT_2_FUNCTIONS_H
+
+#include "display_variants/variant_2_font.h"
+#include "display_variants/layout_engine.h"
+
+namespace VFD_Variant2 {
+
+/**
+ * Character positions of a "1 char per grid display" (up to the 11 grids of the controller).
+ * The colon symbol is displayed on grids 3 and 5
+ * (between chars 3 and 4, and 5 and 6).
+ */
+static constexpr uint16_t colonSymbol = (colonSymbolMSB << 8) | colonSymbolLSB;
+static constexpr VFD_CharSlot CHAR_SLOTS[] = {
+    {1,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {2,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {3,  VFD_PART_GRID, VFD_PLANE_GLYPH, colonSymbol},
+    {4,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {5,  VFD_PART_GRID, VFD_PLANE_GLYPH, colonSymbol},
+    {6,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {7,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {8,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {9,  VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {10, VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+    {11, VFD_PART_GRID, VFD_PLANE_GLYPH, 0},
+};
+
+/**
+ * Descriptor of the layout, see VFD_LayoutEngine.
+ */
+struct Descriptor
+{
+    static constexpr uint8_t positions = sizeof(CHAR_SLOTS) / sizeof(CHAR_SLOTS[0]);
+    static constexpr VFD_CharSlot slot(uint8_t position) { return CHAR_SLOTS[position - 1]; }
+
+    static inline uint8_t fontLSB(char character) { return VFD_fontLSB(character); }
+    static inline uint8_t fontMSB(char character) { return VFD_fontMSB(character); }
+};
+
+/**
+ * Layout of a "1 char per grid display".
+ * The text functions (writeString(), writeChar(), writeGlyph(), gridPosition(), setColon())
+ * are generated from the descriptor.
+ */
+struct Layout : VFD_LayoutEngine<Descriptor>
+{
+    typedef VFD_Variant2::SpinnerFrames SpinnerFrames;
+    // Encoded character (see fontGlyph()): MSB part in the high byte, LSB part in the low byte
+    typedef uint16_t Glyph;
+    // Bytes used by the busy spinning circle
+    static constexpr uint8_t spinnerBytes = VFD_Variant2::spinnerBytes;
+    // Number of glyphs in the font
+    static constexpr uint8_t fontSize     = sizeof(FONT) / sizeof(FONT[0]);
+    // The '.' character of the font is displayed
+    static constexpr bool    decimalPoint = true;
+
+    static inline Glyph fontGlyph(char character) { return VFD_fontGlyph(character); }
+    static inline uint8_t iconFont(uint8_t icon_font_index) { return VFD_iconFont(icon_font_index); }
+
+    template<class Driver>
+    static uint8_t busySpinningCircleFrame(uint8_t position, uint8_t frame_number, uint8_t loop_number);
+};
+
+
+/**
+ * @brief Draw a frame of the busy spinning circle that uses 2 bytes (full grid)
+ *      in animationBuffer (merged with the text on flush).
+ * @param position Grid number where the animation frames must be displayed
+ *      (range 1..Driver::grids).
+ * @param frame_number Current frame to display (Value range 1..6 (6 segments)).
+ * @param loop_number Number of refreshes of the frame (Value range 0..69);
+ *      used to set the duty cycle of fading frames.
+ * @return Memory address of the first modified byte (spinnerBytes are modified).
+ * @note
+ *      The animation takes place on the current position set by the value of cursor.
+ *      The concerned segments for this display are localized on the grid 1.
+ *      The segments are: 4, 1, 12, 13, 16, 5.
+ *
+ *      A same frame is refreshed 70 times before moving to the next.
+ *      An entire loop is made in 420 calls (6 frames * 70 calls each).
+ *      It's up to you to adjust the total time of a loop to 1 second by setting up
+ *      a delay (VFD_BUSY_DELAY) after a call (should be ~2.35ms).
+ *      The number of refreshes for a frame is stored in loop_number.
+ *
+ *      A frame is composed of segments displayed at different duty cycles (1, 1/2, 1/5, 1/12)
+ *      to obtain a fading effect for the segments behind the main segment.
+ *      Frames are precomputed in flash (see SpinnerFrames in variant_2_font.h).
+ *      Ex: For 5th main segment:
+ *          16, 13, 12 are displayed, from the most marked to the darkest;
+ *          the others are not displayed (1, 4).
+ * @see VFD_busySpinningCircle(), VFD_spinnerStart()
+ */
+template<class Driver>
+uint8_t Layout::busySpinningCircleFrame(uint8_t position, uint8_t frame_number, uint8_t loop_number)
+{
+    uint16_t segments = SpinnerFrames::word(frame_number, loop_number);
+
+    uint8_t address = (position * PT6312_BYTES_PER_GRID) - PT6312_BYTES_PER_GRID;
+    Driver::animationBuffer[address]     = segments & 0xFF; // lsb
+    Driver::animationBuffer[address + 1] = segments >> 8;   // msb
+    return address;
+}
+
+} // namespace VFD_Variant2
+
+#endif
@@ -0,0 +1,174 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Brightness fades driven by the timer interrupt (see ENABLE_TIMER in global.h).
+ *
+ * Levels are counted in 1/VFD_FADE_STEPS of a brightness setting of the controller;
+ * the intermediate levels are obtained by alternating the 2 adjacent settings
+ * (temporal dithering) at each interrupt.
+ */
+#include "PT6312.h"
+
+#if ENABLE_TIMER == 1
+
+static_assert(VFD_FADE_STEPS >= 1 && VFD_FADE_STEPS <= 32 && (VFD_FADE_STEPS & (VFD_FADE_STEPS - 1)) == 0,
+              "VFD_FADE_STEPS must be a power of 2 in 1..32");
+
+// Max duration of a fade in timer interrupts (the ramp accumulator is 16 bits)
+#define VFD_FADE_MAX_TICKS  0xFF00
+
+/**
+ * State of the fade engine, only modified by the timer interrupt while running
+ * @see VFD_fadeTo()
+ */
+static struct {
+    volatile bool running;
+    volatile bool ramping;      // The target level is not reached
+    uint8_t       level;        // Current level
+    int8_t        direction;    // Step of the level during the ramp: +1 or -1
+    uint8_t       delta;        // Number of levels of the ramp
+    uint16_t      ticks;        // Duration of the ramp in timer interrupts
+    uint16_t      remaining;    // Timer interrupts until the end of the ramp
+    uint16_t      error;        // Accumulator of the ramp (levels * ticks)
+    uint8_t       dither;       // Accumulator of the dithering
+} fade = {false, false, VFD_BRIGHTNESS_LEVEL(PT6312_BRT_DEF), 1, 0, 0, 0, 0, 0};
+
+
+/**
+ * @brief Fade the brightness of the display to the given level, in background.
+ *      The fade starts from the current level of the fade engine: the level reached by the
+ *      previous fade, VFD_BRIGHTNESS_LEVEL(PT6312_BRT_DEF) after the startup.
+ *      The level is updated by the timer interrupt at VFD_TIMER_FREQUENCY; a display control
+ *      command is sent only when the brightness setting of the controller changes.
+ *      Levels between 2 settings are obtained by dithering, which continues after the end
+ *      of the fade (1 command every few interrupts); levels multiple of VFD_FADE_STEPS
+ *      don't use the bus once reached.
+ *      Ex: VFD_fadeTo(VFD_BRIGHTNESS_LEVEL(PT6312_BRT0), 2000); // Dim in 2 seconds
+ * @param level Target level (range 0..VFD_BRIGHTNESS_LEVEL_MAX); see VFD_BRIGHTNESS_LEVEL().
+ * @param duration_ms Duration of the fade (max ~65000 interrupts: 155s at 420 Hz);
+ *      0: the level is applied by the next interrupt.
+ * @note VFD_setBrightness() is not tracked: a running fade overwrites its setting,
+ *      the next fade starts from the level of the engine. VFD_resetDisplay() (called by
+ *      the scrolling and the busy spinning circle) keeps the brightness of the fade.
+ * @see VFD_fadeRunning(), VFD_fadeStop()
+ */
+void VFD_fadeTo(uint8_t level, uint16_t duration_ms)
+{
+    fade.running = false;
+
+    if (level > VFD_BRIGHTNESS_LEVEL_MAX) {
+        level = VFD_BRIGHTNESS_LEVEL_MAX;
+    }
+
+    uint32_t ticks = (uint32_t)duration_ms * VFD_TIMER_FREQUENCY / 1000;
+    if (ticks > VFD_FADE_MAX_TICKS) {
+        ticks = VFD_FADE_MAX_TICKS;
+    }
+
+    if (ticks == 0 || level == fade.level) {
+        fade.level     = level;
+        fade.remaining = 0;
+        fade.ramping   = false;
+    }else{
+        fade.direction = (level > fade.level) ? 1 : -1;
+        fade.delta     = (level > fade.level) ? level - fade.level : fade.level - level;
+        fade.ticks     = ticks;
+        fade.remaining = ticks;
+        fade.error     = 0;
+        fade.ramping   = true;
+    }
+    fade.running = true;
+}
+
+
+/**
+ * @brief Set the brightness level of the display, with dithering for the intermediate levels.
+ *      Same as VFD_fadeTo(level, 0).
+ * @param level Range 0..VFD_BRIGHTNESS_LEVEL_MAX; see VFD_BRIGHTNESS_LEVEL().
+ */
+void VFD_setBrightnessLevel(uint8_t level)
+{
+    VFD_fadeTo(level, 0);
+}
+
+
+/**
+ * @brief Test if a fade started with VFD_fadeTo() is in progress.
+ * @return False when the target level is reached (its dithering may continue).
+ */
+bool VFD_fadeRunning(void)
+{
+    return fade.running && fade.ramping;
+}
+
+
+/**
+ * @brief Stop the fade engine; the brightness setting of the controller is left as is
+ *      (the dithering of an intermediate level is stopped).
+ */
+void VFD_fadeStop(void)
+{
+    fade.running = false;
+}
+
+
+/**
+ * @brief Step of the fade and of the dithering.
+ *      Called by the timer interrupt.
+ *      The command is postponed to the next interrupt if the bus is in use by the main program.
+ */
+void VFD_fadeInterrupt(void)
+{
+    if (!fade.running) {
+        return;
+    }
+
+    // Ramp: delta levels spread over ticks interrupts
+    if (fade.remaining) {
+        fade.remaining--;
+        fade.error += fade.delta;
+        while (fade.error >= fade.ticks) {
+            fade.error -= fade.ticks;
+            fade.level += fade.direction;
+        }
+        if (!fade.remaining) {
+            fade.ramping = false;
+        }
+    }
+
+    // Dithering: the upper setting is displayed fraction / VFD_FADE_STEPS of the time
+    uint8_t brightness = fade.level / VFD_FADE_STEPS;
+    uint8_t fraction   = fade.level & (VFD_FADE_STEPS - 1);
+    fade.dither += fraction;
+    if (fade.dither >= VFD_FADE_STEPS) {
+        fade.dither -= VFD_FADE_STEPS;
+        brightness++;
+    }
+
+    // A transmission is in progress
+    if (!VFD_busIdle()) {
+        return;
+    }
+    // Sent only if the setting changes
+    VFD_Driver::setDisplayControl(PT6312_DSP_CTRL_CMD | PT6312_DSP_ON | brightness);
+
+    if (!fade.remaining && !fraction) {
+        // Target reached, no dithering
+        fade.running = false;
+    }
+}
+#endif
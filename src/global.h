@@ -36,13 +36,57 @@
 #define VFD_DATA_PORT           PORTB
 #define VFD_DATA_PIN            PB2
 #define VFD_DATA_R_ONLY_PORT    PINB
+// Linux backend only (built with -DVFD_LINUX): offsets of the GPIO lines on the chip
+// (CS: index of the device with spidev), see linux/linux_hal.h
+#define VFD_CS_LINE             17
+#define VFD_SCLK_LINE           27
+#define VFD_DATA_LINE           22
+// Transport used to exchange bytes with the controller:
+// VFD_TRANSPORT_BITBANG (any pins), VFD_TRANSPORT_USI (ATtiny), VFD_TRANSPORT_SPI (ATmega)
+// or VFD_TRANSPORT_LINUX (Linux backend: transactions batched by the GPIO interface).
+// With a hardware transport, SCLK/DATA above MUST be the USCK/DO (USI) or SCK/MOSI (SPI) pins
+// and the DI (USI) or MISO (SPI) pin below MUST be wired to the DATA line too.
+// Ex for the ATtiny85 (USI): PB3 for CS/STB, PB2 for SCLK, PB1 for DATA, PB0 for DATA IN.
+#define VFD_TRANSPORT           VFD_TRANSPORT_BITBANG
+#define VFD_DATA_IN_DDR         DDRB
+#define VFD_DATA_IN_PIN         PB0
+// SPI only: SS pin of the MCU, must stay an output to keep the SPI in master mode
+#define VFD_SPI_SS_DDR          DDRB
+#define VFD_SPI_SS_PIN          PB2
 // VFD Display features
 #define VFD_GRIDS               4 // Number of grids
 #define VFD_DISPLAYABLE_DIGITS  6 // Number of characters that can be displayed simultaneously
 #define VFD_SCROLL_DELAY        500 // In milliseconds
+#define VFD_SCROLL_START_DELAY  1000 // In milliseconds, display time of the first characters
+#define VFD_SCROLL_END_DELAY    2000 // In milliseconds, display time of the last characters
 #define VFD_BUSY_DELAY          2.35 // In milliseconds
 // Library options
+#define VFD_POWER_UP_DELAY      500 // In milliseconds; max startup time of the controller after power-up
+#define VFD_POWER_UP_PROBE      0 // End the startup delay as soon as the controller answers a switch read
+                                  // (unused bits read as 0; an absent/unready controller leaves DATA pulled up)
 #define ENABLE_ICON_BUFFER      0 // Enable functions and extra buffer to display icons (except spinning circle)
+#define VFD_WAKE_UP_RESEND      0 // Resend the display control and data setting commands on each VFD_resetDisplay()
+                                  // even if they are unchanged (for panels that turn black without them)
+#define ENABLE_TIMER            0 // Enable the timer interrupt of the background features (spinning circle)
+                                  // Uses Timer1 on ATtiny25/45/85, Timer2 on ATmega
+#define VFD_TIMER_FREQUENCY     420 // In Hz; frequency of the timer interrupt (420 = 1 spinning circle loop per second)
+#define VFD_FADE_STEPS          8 // Levels per brightness setting for VFD_fadeTo() (power of 2, max 32);
+                                  // the intermediate levels are dithered by the timer interrupt
+#define VFD_CLOCK_TIMER         0 // Advance the clock of VFD_clockStart() in the timer interrupt (ENABLE_TIMER is required)
+                                  // 0: VFD_clockTick() must be called every second
+#define ENABLE_KEY_SCANNER      0 // Scan the keys in the timer interrupt, see VFD_readKeyEvent() (ENABLE_TIMER is required)
+#define VFD_KEY_SCAN_FREQUENCY  60 // In Hz; must divide VFD_TIMER_FREQUENCY
+#define VFD_KEY_DEBOUNCE        3 // Number of identical consecutive scans required to accept a change of the keys
+#define VFD_KEY_LONG_PRESS      1000 // In milliseconds; a key held this long emits a long press event
+#define VFD_KEY_REPEAT          200 // In milliseconds; then a repeat event is emitted at this period (0: no repeat)
+#define VFD_KEY_EVENTS          8 // Size of the queue of key events (power of 2, max 128)
+#define VFD_TX_QUEUE_SIZE       0 // Size of the transmit queue (power of 2, max 128; 0: disabled): the writes of the main
+                                  // program are queued and sent by the timer interrupt (ENABLE_TIMER is required)
+#define VFD_TX_BURST            4 // Max number of queued bytes sent per timer interrupt (less than VFD_TX_QUEUE_SIZE - 1)
+#define VFD_STATS               0 // Count the bus operations and the cycles spent in VFD_command()/VFD_readByte(),
+                                  // see VFD_stats (cycles measured by the timer of ENABLE_TIMER or VFD_statsCycles())
+#define VFD_TRACE_HOOKS         0 // Call VFD_transactionBegin()/VFD_transactionEnd() around each transaction
+                                  // (weak functions, Ex: toggle a spare pin for timing measurements with a scope)
 
 // Fonts (files are included in ET16312N.cpp)
 // "2 chars per grid display"
@@ -0,0 +1,57 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Glyphs of the fonts built at compile time from segment numbers.
+ */
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include "PT6312.h"
+
+/**
+ * 16 bits word of a glyph (bits 0..15 for segments 1..16).
+ * @tparam Segments Segment numbers (starting from 1) to light; checked against
+ *      VFD_SEGMENTS (number of segments for the configured number of grids).
+ */
+template<uint8_t... Segments> struct VFD_Glyph;
+
+template<>
+struct VFD_Glyph<>
+{
+    static constexpr uint16_t word = 0;
+};
+
+template<uint8_t Segment, uint8_t... Segments>
+struct VFD_Glyph<Segment, Segments...>
+{
+    static_assert((Segment >= 1) && (Segment <= VFD_SEGMENTS),
+                  "Segment number out of range for VFD_SEGMENTS");
+    static_assert((VFD_Glyph<Segments...>::word & (1U << (Segment - 1))) == 0,
+                  "Duplicate segment number");
+
+    static constexpr uint16_t word = (1U << (Segment - 1)) | VFD_Glyph<Segments...>::word;
+};
+
+/**
+ * Entry of the FONT array ({MSB, LSB}) from a list of segment numbers.
+ * Ex: VFD_GLYPH(8, 7, 6, 4, 3, 2) gives {0b00000000, 0b11101110};
+ *     VFD_GLYPH() gives an empty glyph.
+ */
+#define VFD_GLYPH(...) \
+    {(uint8_t)(VFD_Glyph<__VA_ARGS__>::word >> 8), (uint8_t)(VFD_Glyph<__VA_ARGS__>::word & 0xFF)}
+
+#endif
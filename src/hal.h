@@ -0,0 +1,40 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Hardware abstraction: registers, delays, flash & interrupts.
+ * AVR headers on the target, userspace GPIO on a Linux single-board computer (VFD_LINUX),
+ * virtual MCU + PT6312 simulator on a PC (VFD_HOST).
+ */
+#ifndef VFD_HAL_H
+#define VFD_HAL_H
+
+#if defined(__AVR__)
+    #include <avr/io.h>
+    #include <avr/pgmspace.h>
+    #include <avr/interrupt.h>
+    #include <util/delay.h>
+    #include <util/atomic.h>
+#elif defined(VFD_LINUX)
+    // Linux single-board computer (-DVFD_LINUX): see linux/linux_hal.h
+    #include "linux/linux_hal.h"
+#else
+    // Linux build: see host/host_hal.h
+    #define VFD_HOST 1
+    #include "host/host_hal.h"
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host (Linux) backend: virtual IO ports, clock and interrupts.
+ * Empty on AVR targets.
+ */
+#include "../hal.h"
+
+#ifdef VFD_HOST
+
+static uint8_t  vfd_host_ddr[VFD_HOST_PORTS];
+static uint8_t  vfd_host_port[VFD_HOST_PORTS];
+
+static uint64_t vfd_host_time;
+static uint64_t vfd_host_bus_time;
+static bool     vfd_host_interrupts = true;
+static bool     vfd_host_in_interrupt;
+static void     (*vfd_host_timer_interrupt)(void);
+static uint64_t vfd_host_timer_period;
+static uint64_t vfd_host_timer_next;
+static uint32_t vfd_host_flash_reads;
+
+
+/**
+ * @brief Get the level of a line of the virtual MCU.
+ *      Level set by the MCU for an output, level driven by a simulated controller
+ *      for an input; inputs that are not driven are pulled up.
+ * @param port VFD_HOST_PORT_B, VFD_HOST_PORT_C or VFD_HOST_PORT_D.
+ * @param pin Bit number in the port.
+ */
+bool VFD_hostLineLevel(uint8_t port, uint8_t pin)
+{
+    if (vfd_host_ddr[port] & (1 << pin)) {
+        return vfd_host_port[port] & (1 << pin);
+    }
+    bool level;
+    if (VFD_HostPT6312::drivesPin(port, pin, level)) {
+        return level;
+    }
+    return true;
+}
+
+
+VFD_HostRegister::operator uint8_t() const
+{
+    if (type == VFD_HOST_DDR) {
+        return vfd_host_ddr[port];
+    }
+    if (type == VFD_HOST_PORT) {
+        return vfd_host_port[port];
+    }
+
+    uint8_t levels = 0;
+    for (uint8_t pin = 0; pin < 8; pin++) {
+        if (VFD_hostLineLevel(port, pin)) {
+            levels |= (1 << pin);
+        }
+    }
+    return levels;
+}
+
+
+const VFD_HostRegister &VFD_HostRegister::operator=(uint8_t value) const
+{
+    if (type == VFD_HOST_DDR) {
+        vfd_host_ddr[port] = value;
+    }else if (type == VFD_HOST_PORT) {
+        vfd_host_port[port] = value;
+    }else{
+        // Writing a 1 to a PIN register toggles the PORT bit
+        vfd_host_port[port] ^= value;
+    }
+    VFD_HostPT6312::pinsChanged();
+    return *this;
+}
+
+
+/**
+ * @return Nanoseconds of the virtual clock elapsed since the start of the program.
+ */
+uint64_t VFD_hostNanos(void)
+{
+    return vfd_host_time;
+}
+
+
+/**
+ * @return Nanoseconds spent in _delay_us() since the start of the program.
+ */
+uint64_t VFD_hostBusNanos(void)
+{
+    return vfd_host_bus_time;
+}
+
+
+/**
+ * @brief Advance the virtual clock.
+ *      The timer interrupt is called at each of its periods in the delay;
+ *      like on the MCU, the time spent in the interrupt extends the delay.
+ */
+void VFD_hostDelay(uint64_t nanoseconds)
+{
+    uint64_t end = vfd_host_time + nanoseconds;
+
+    while (vfd_host_timer_interrupt && vfd_host_interrupts && !vfd_host_in_interrupt
+           && vfd_host_timer_next <= end) {
+        vfd_host_time = vfd_host_timer_next;
+
+        vfd_host_in_interrupt = true;
+        vfd_host_timer_interrupt();
+        vfd_host_in_interrupt = false;
+
+        end += vfd_host_time - vfd_host_timer_next;
+        vfd_host_timer_next += vfd_host_timer_period;
+        // Interrupts longer than the period: pending ones are merged
+        if (vfd_host_timer_next <= vfd_host_time) {
+            vfd_host_timer_next = vfd_host_time + vfd_host_timer_period;
+        }
+    }
+    vfd_host_time = end;
+}
+
+
+/**
+ * @brief Advance the virtual clock for the timings of the bus signals (_delay_us()).
+ * @see VFD_hostBusNanos()
+ */
+void VFD_hostBusDelay(uint64_t nanoseconds)
+{
+    vfd_host_bus_time += nanoseconds;
+    VFD_hostDelay(nanoseconds);
+}
+
+
+/**
+ * @brief Read a byte of PROGMEM data (pgm_read_byte()).
+ */
+uint8_t VFD_hostFlashByte(const void *address)
+{
+    vfd_host_flash_reads++;
+    return *(const uint8_t *)address;
+}
+
+
+/**
+ * @brief Read a word of PROGMEM data (pgm_read_word()).
+ */
+uint16_t VFD_hostFlashWord(const void *address)
+{
+    vfd_host_flash_reads += 2;
+    return *(const uint16_t *)address;
+}
+
+
+/**
+ * @return Bytes read from the flash memory since the start of the program.
+ */
+uint32_t VFD_hostFlashReads(void)
+{
+    return vfd_host_flash_reads;
+}
+
+
+/**
+ * @brief Enable or disable the interrupts (sei(), cli()).
+ */
+void VFD_hostInterrupts(bool enabled)
+{
+    vfd_host_interrupts = enabled;
+}
+
+
+/**
+ * @brief Start a periodic interrupt on the virtual clock.
+ * @param interrupt Function to call.
+ * @param period Period in nanoseconds.
+ */
+void VFD_hostTimerStart(void (*interrupt)(void), uint64_t period)
+{
+    vfd_host_timer_interrupt = interrupt;
+    vfd_host_timer_period    = period;
+    vfd_host_timer_next      = vfd_host_time + period;
+}
+
+#endif
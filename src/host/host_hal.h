@@ -0,0 +1,170 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host (Linux) backend of the hardware abstraction: virtual MCU for builds on a PC.
+ *
+ * - IO ports B, C, D are virtual registers; every write to a DDR/PORT register
+ *   is forwarded to the simulated controllers (see pt6312_sim.h) that decode
+ *   the CS/SCLK/DATA bitstream, reads of a PIN register return the levels driven
+ *   by the simulated controllers.
+ * - Delays do not sleep: they advance a virtual clock (see VFD_hostNanos()).
+ * - The timer interrupt is called by the delays when its period is elapsed,
+ *   if the interrupts are enabled.
+ * - PROGMEM data stays in RAM; the reads are counted (see VFD_hostFlashReads()).
+ *
+ * This file is included by hal.h when the target is not an AVR MCU.
+ */
+#ifndef VFD_HOST_HAL_H
+#define VFD_HOST_HAL_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/**
+ * Virtual IO registers
+ */
+#define VFD_HOST_PORT_B     0
+#define VFD_HOST_PORT_C     1
+#define VFD_HOST_PORT_D     2
+#define VFD_HOST_PORTS      3
+
+enum VFD_HostRegisterType {
+    VFD_HOST_DDR,
+    VFD_HOST_PORT,
+    VFD_HOST_PIN
+};
+
+/**
+ * Handle on a virtual IO register; used like the registers of avr/io.h
+ * (Ex: PORTB |= (1 << PB1)).
+ */
+class VFD_HostRegister
+{
+public:
+    constexpr VFD_HostRegister(uint8_t port, VFD_HostRegisterType type) : port(port), type(type) {}
+
+    operator uint8_t() const;
+    const VFD_HostRegister &operator=(uint8_t value) const;
+    const VFD_HostRegister &operator|=(uint8_t value) const { return *this = *this | value; }
+    const VFD_HostRegister &operator&=(uint8_t value) const { return *this = *this & value; }
+    const VFD_HostRegister &operator^=(uint8_t value) const { return *this = *this ^ value; }
+
+    const uint8_t              port;
+    const VFD_HostRegisterType type;
+};
+
+#define DDRB    VFD_HostRegister(VFD_HOST_PORT_B, VFD_HOST_DDR)
+#define PORTB   VFD_HostRegister(VFD_HOST_PORT_B, VFD_HOST_PORT)
+#define PINB    VFD_HostRegister(VFD_HOST_PORT_B, VFD_HOST_PIN)
+#define DDRC    VFD_HostRegister(VFD_HOST_PORT_C, VFD_HOST_DDR)
+#define PORTC   VFD_HostRegister(VFD_HOST_PORT_C, VFD_HOST_PORT)
+#define PINC    VFD_HostRegister(VFD_HOST_PORT_C, VFD_HOST_PIN)
+#define DDRD    VFD_HostRegister(VFD_HOST_PORT_D, VFD_HOST_DDR)
+#define PORTD   VFD_HostRegister(VFD_HOST_PORT_D, VFD_HOST_PORT)
+#define PIND    VFD_HostRegister(VFD_HOST_PORT_D, VFD_HOST_PIN)
+
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// Level of a line: set by the MCU (output), driven by a simulated controller
+// or pulled up (input)
+bool VFD_hostLineLevel(uint8_t port, uint8_t pin);
+
+#define _BV(bit)                            (1 << (bit))
+#define bit_is_set(sfr, bit)                ((uint8_t)(sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)              (!((uint8_t)(sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit)     do { } while (bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit)   do { } while (bit_is_set(sfr, bit))
+
+/**
+ * Virtual clock & delays
+ */
+// Nanoseconds elapsed since the start of the program
+uint64_t VFD_hostNanos(void);
+// Nanoseconds spent in _delay_us() since the start of the program (timings of the bus signals)
+uint64_t VFD_hostBusNanos(void);
+void VFD_hostDelay(uint64_t nanoseconds);
+void VFD_hostBusDelay(uint64_t nanoseconds);
+
+static inline void _delay_us(double us)
+{
+    VFD_hostBusDelay((uint64_t)(us * 1000.0));
+}
+
+static inline void _delay_ms(double ms)
+{
+    VFD_hostDelay((uint64_t)(ms * 1000000.0));
+}
+
+/**
+ * Flash memory: data stays in RAM (same byte order as the AVR)
+ */
+uint8_t VFD_hostFlashByte(const void *address);
+uint16_t VFD_hostFlashWord(const void *address);
+// Bytes read with pgm_read_byte()/pgm_read_word() since the start of the program
+uint32_t VFD_hostFlashReads(void);
+
+#define PROGMEM
+#define pgm_read_byte(address)  VFD_hostFlashByte(address)
+#define pgm_read_word(address)  VFD_hostFlashWord(address)
+
+/**
+ * Interrupts
+ */
+void VFD_hostInterrupts(bool enabled);
+// Call the given function every period (of the virtual clock) while interrupts are enabled
+void VFD_hostTimerStart(void (*interrupt)(void), uint64_t period);
+
+#define sei()   VFD_hostInterrupts(true)
+#define cli()   VFD_hostInterrupts(false)
+// The timer interrupt never preempts the main program: the atomic blocks are plain blocks
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type)  for (bool vfd_atomic = true; vfd_atomic; vfd_atomic = false)
+#define ISR(vector) \
+    extern "C" void vector(void); \
+    extern "C" void vector(void)
+
+// Vector of the timer interrupt of the library (see timer.cpp)
+extern "C" void VFD_HOST_TIMER_vect(void);
+
+#include "pt6312_sim.h"
+
+#endif
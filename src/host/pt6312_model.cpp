@@ -0,0 +1,280 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Model of a PT6312 controller, shared by the host and Linux backends.
+ * Empty on AVR targets.
+ */
+#include "../PT6312.h"
+
+#if defined(VFD_HOST) || defined(VFD_LINUX)
+
+#include "pt6312_model.h"
+
+
+VFD_PT6312Model::VFD_PT6312Model()
+    : keyScript(0), keyScriptLength(0), powerUpNanos(0)
+{
+    reset();
+}
+
+
+/**
+ * @brief Set the power-on state: display off, 7 grids mode, LEDs off,
+ *      display memory cleared (random on the real controller), no key pressed.
+ *      Statistics are cleared; the lines are assumed to be idle (CS & SCLK HIGH).
+ */
+void VFD_PT6312Model::reset(void)
+{
+    for (uint8_t i = 0; i < VFD_HOST_PT6312_MEM; i++) {
+        memory[i] = 0;
+    }
+    displayMode    = PT6312_GR7_SEG15;
+    dataSetting    = PT6312_DATA_WR | PT6312_ADDR_INC | PT6312_MODE_NORM;
+    displayControl = PT6312_DSP_OFF;
+    address        = 0;
+    ledPort        = 0xFF;
+    setKeys(0);
+    switchMemory   = 0;
+
+    resetStatistics();
+
+    csLevel       = true;
+    sclkLevel     = true;
+    shiftRegister = 0;
+    bitCount      = 0;
+    byteCount     = 0;
+    reading       = false;
+    dataLevel     = true;
+}
+
+
+void VFD_PT6312Model::resetStatistics(void)
+{
+    transmissions = 0;
+    sclkEdges     = 0;
+    commands      = 0;
+    dataBytes     = 0;
+    readBytes     = 0;
+}
+
+
+uint8_t VFD_PT6312Model::grids(void) const
+{
+    return 4 + displayMode;
+}
+
+
+uint16_t VFD_PT6312Model::gridSegments(uint8_t grid) const
+{
+    uint8_t addr = (grid - 1) * PT6312_BYTES_PER_GRID;
+    return memory[addr] | (memory[addr + 1] << 8);
+}
+
+
+bool VFD_PT6312Model::displayOn(void) const
+{
+    return displayControl & PT6312_DSP_ON;
+}
+
+
+uint8_t VFD_PT6312Model::brightness(void) const
+{
+    return displayControl & PT6312_BRT_MSK;
+}
+
+
+uint8_t VFD_PT6312Model::ledsOn(void) const
+{
+    return ~ledPort & PT6312_LED_MSK;
+}
+
+
+void VFD_PT6312Model::setKeys(uint32_t keys)
+{
+    keyMemory[0] = keys >> 16;
+    keyMemory[1] = keys >> 8;
+    keyMemory[2] = keys;
+}
+
+
+void VFD_PT6312Model::setKeyScript(const VFD_HostKeyEvent *events, uint8_t count)
+{
+    keyScript       = events;
+    keyScriptLength = count;
+}
+
+
+void VFD_PT6312Model::setSwitches(uint8_t switches)
+{
+    switchMemory = switches;
+}
+
+
+void VFD_PT6312Model::setPowerUpTime(uint32_t time_us)
+{
+    powerUpNanos = (uint64_t)time_us * 1000;
+}
+
+
+/**
+ * @brief Apply the last event of the key script reached by the clock.
+ */
+void VFD_PT6312Model::applyKeyScript(uint64_t now)
+{
+    now /= 1000;
+
+    for (uint8_t i = 0; i < keyScriptLength && keyScript[i].time_us <= now; i++) {
+        setKeys(keyScript[i].keys);
+    }
+}
+
+
+/**
+ * @brief Decode the levels of the lines after a change.
+ * @param cs, sclk, data Levels of the lines.
+ * @param now Time of the clock of the backend in nanoseconds.
+ */
+void VFD_PT6312Model::sample(bool cs, bool sclk, bool data, uint64_t now)
+{
+    if (now < powerUpNanos) {
+        // Not started: the lines are ignored, DATA is not driven
+        csLevel   = true;
+        sclkLevel = sclk;
+        reading   = false;
+        return;
+    }
+
+    if (cs != csLevel) {
+        csLevel = cs;
+        if (!cs) {
+            // Start of a transmission: the first byte is a command
+            shiftRegister = 0;
+            bitCount      = 0;
+            byteCount     = 0;
+        }else{
+            transmissions++;
+        }
+        reading = false;
+    }
+
+    if (sclk == sclkLevel) {
+        return;
+    }
+    sclkLevel = sclk;
+
+    if (csLevel) {
+        return;
+    }
+    sclkEdges++;
+
+    if (reading) {
+        // Data is shifted out on the falling edges
+        if (!sclk) {
+            dataLevel = (readBit < readLength * 8) ? (readBuffer[readBit >> 3] >> (readBit & 7)) & 1 : true;
+            readBit++;
+            if ((readBit & 7) == 0) {
+                readBytes++;
+            }
+        }
+        return;
+    }
+
+    // Data is latched on the rising edges
+    if (sclk) {
+        if (data) {
+            shiftRegister |= (1 << bitCount);
+        }
+        if (++bitCount == 8) {
+            receiveByte(shiftRegister, now);
+            shiftRegister = 0;
+            bitCount      = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Execute a command or store a data byte.
+ */
+void VFD_PT6312Model::receiveByte(uint8_t value, uint64_t now)
+{
+    if (byteCount++ == 0) {
+        commands++;
+
+        switch (value & 0xC0) {
+        case PT6312_MODE_SET_CMD:
+            displayMode = value & 0x07;
+            break;
+        case PT6312_DATA_SET_CMD:
+            dataSetting = value & 0x0F;
+            if ((value & 0x03) == PT6312_KEY_RD) {
+                applyKeyScript(now);
+                for (uint8_t i = 0; i < PT6312_KEY_MEM; i++) {
+                    readBuffer[i] = keyMemory[i];
+                }
+                readLength = PT6312_KEY_MEM;
+            }else if ((value & 0x03) == PT6312_SW_RD) {
+                readBuffer[0] = switchMemory;
+                readLength    = 1;
+            }else{
+                break;
+            }
+            // The controller drives the DATA line until the end of the transmission
+            reading   = true;
+            readBit   = 0;
+            dataLevel = true;
+            break;
+        case PT6312_DSP_CTRL_CMD:
+            displayControl = value & 0x0F;
+            break;
+        case PT6312_ADDR_SET_CMD:
+            address = value & PT6312_ADDR_MSK;
+            break;
+        }
+        return;
+    }
+
+    dataBytes++;
+
+    if ((dataSetting & 0x03) == PT6312_LED_WR) {
+        ledPort = value;
+        return;
+    }
+
+    if (address < VFD_HOST_PT6312_MEM) {
+        memory[address] = value;
+    }
+    if (!(dataSetting & PT6312_ADDR_FIXED)) {
+        address++;
+    }
+}
+
+
+/**
+ * @brief Test if the controller drives the DATA line (key or switch read in a transmission).
+ * @param level Set to the level of the line if it is driven.
+ */
+bool VFD_PT6312Model::drivesData(bool &level) const
+{
+    if (reading && !csLevel) {
+        level = dataLevel;
+        return true;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,140 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Model of a PT6312 controller fed with the levels of its CS/SCLK/DATA lines.
+ * Shared by the virtual controller of the host backend (see pt6312_sim.h)
+ * and the mock GPIO chip of the Linux backend (see linux/linux_mock.h).
+ */
+#ifndef VFD_PT6312_MODEL_H
+#define VFD_PT6312_MODEL_H
+
+#include <stdint.h>
+
+// Size of the display memory of the controller (addresses 0x00..0x15)
+#define VFD_HOST_PT6312_MEM     22
+
+/**
+ * Step of a key script: from the given time, the controller reports these keys.
+ */
+struct VFD_HostKeyEvent
+{
+    // Time of the clock of the backend in microseconds (Ex: VFD_hostNanos())
+    uint32_t time_us;
+    // Keys in the format returned by VFD_getKeys() (6 samples of 4 bits)
+    uint32_t keys;
+};
+
+/**
+ * PT6312 controller.
+ *
+ * The bitstream on the CS/SCLK/DATA lines is decoded like the real controller:
+ * bits are latched on the rising edges of SCLK (least significant bit first),
+ * the first byte after the falling edge of CS is a command, the next ones are data.
+ * Key and switch data are shifted out on the falling edges of SCLK.
+ *
+ * The lines are given by the owner of the model at each change (see sample()).
+ */
+class VFD_PT6312Model
+{
+public:
+    VFD_PT6312Model();
+
+    // Power-on state
+    void reset(void);
+    void resetStatistics(void);
+
+    // Number of grids of the display mode (4..11)
+    uint8_t grids(void) const;
+    // 16 bits word of segments of a grid (starting from 1)
+    uint16_t gridSegments(uint8_t grid) const;
+    bool displayOn(void) const;
+    // Brightness setting (0..7)
+    uint8_t brightness(void) const;
+    // Lit LEDs: bit 0 for LED 1 (the LED port is active LOW)
+    uint8_t ledsOn(void) const;
+
+    // Keys in the format returned by VFD_getKeys()
+    void setKeys(uint32_t keys);
+    // Keys applied according to the clock of the backend; the events must be sorted by time
+    void setKeyScript(const VFD_HostKeyEvent *events, uint8_t count);
+    // Switches in the format returned by VFD_getSwitches()
+    void setSwitches(uint8_t switches);
+    // The controller ignores the bus until the given time of the clock of the backend
+    // (startup after power-up)
+    void setPowerUpTime(uint32_t time_us);
+
+    // Decode the levels of the lines at the given time (nanoseconds of the clock of the backend)
+    void sample(bool cs, bool sclk, bool data, uint64_t now);
+    // Test if the controller drives the DATA line (key or switch read)
+    bool drivesData(bool &level) const;
+
+    /**
+     * State of the controller
+     */
+    uint8_t memory[VFD_HOST_PT6312_MEM];
+    // Last commands received
+    uint8_t displayMode;
+    uint8_t dataSetting;
+    uint8_t displayControl;
+    // Address pointer
+    uint8_t address;
+    // Last byte written to the LED port
+    uint8_t ledPort;
+    // Bytes shifted out by a key read
+    uint8_t keyMemory[3];
+    uint8_t switchMemory;
+
+    /**
+     * Statistics
+     */
+    // CS/Strobe pulses
+    uint32_t transmissions;
+    // Edges on the SCLK line during the transmissions
+    uint32_t sclkEdges;
+    // Commands & data bytes received
+    uint32_t commands;
+    uint32_t dataBytes;
+    // Bytes shifted out (keys & switches)
+    uint32_t readBytes;
+
+protected:
+    // Bus decoding
+    bool    csLevel;
+    bool    sclkLevel;
+
+private:
+    void receiveByte(uint8_t value, uint64_t now);
+    void applyKeyScript(uint64_t now);
+
+    uint8_t shiftRegister;
+    uint8_t bitCount;
+    uint8_t byteCount;
+    // Key or switch read in progress: the controller drives the DATA line
+    bool    reading;
+    bool    dataLevel;
+    uint8_t readBuffer[3];
+    uint8_t readLength;
+    uint8_t readBit;
+
+    const VFD_HostKeyEvent *keyScript;
+    uint8_t keyScriptLength;
+
+    // Time of the end of the startup
+    uint64_t powerUpNanos;
+};
+
+#endif
@@ -0,0 +1,110 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Host (Linux) backend: virtual PT6312 controller.
+ * Empty on AVR targets.
+ */
+#include "../PT6312.h"
+
+#ifdef VFD_HOST
+
+VFD_HostPT6312 *VFD_HostPT6312::controllers[VFD_HOST_PT6312_MAX];
+
+
+VFD_HostPT6312::VFD_HostPT6312(VFD_HostRegister cs_port, uint8_t cs_pin,
+                               VFD_HostRegister sclk_port, uint8_t sclk_pin,
+                               VFD_HostRegister data_port, uint8_t data_pin)
+    : csPort(cs_port.port), csPin(cs_pin),
+      sclkPort(sclk_port.port), sclkPin(sclk_pin),
+      dataPort(data_port.port), dataPin(data_pin)
+{
+    reset();
+
+    for (uint8_t i = 0; i < VFD_HOST_PT6312_MAX; i++) {
+        if (!controllers[i]) {
+            controllers[i] = this;
+            break;
+        }
+    }
+}
+
+
+VFD_HostPT6312::~VFD_HostPT6312()
+{
+    for (uint8_t i = 0; i < VFD_HOST_PT6312_MAX; i++) {
+        if (controllers[i] == this) {
+            controllers[i] = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Set the power-on state (see VFD_PT6312Model::reset()),
+ *      the decoding starts from the current levels of the lines.
+ */
+void VFD_HostPT6312::reset(void)
+{
+    VFD_PT6312Model::reset();
+
+    csLevel   = VFD_hostLineLevel(csPort, csPin);
+    sclkLevel = VFD_hostLineLevel(sclkPort, sclkPin);
+}
+
+
+/**
+ * @brief Decode the levels of the lines after a write to an IO register.
+ */
+void VFD_HostPT6312::sample(void)
+{
+    VFD_PT6312Model::sample(VFD_hostLineLevel(csPort, csPin),
+                            VFD_hostLineLevel(sclkPort, sclkPin),
+                            VFD_hostLineLevel(dataPort, dataPin),
+                            VFD_hostNanos());
+}
+
+
+/**
+ * @brief Forward a write to an IO register to all the simulated controllers.
+ */
+void VFD_HostPT6312::pinsChanged(void)
+{
+    for (uint8_t i = 0; i < VFD_HOST_PT6312_MAX; i++) {
+        if (controllers[i]) {
+            controllers[i]->sample();
+        }
+    }
+}
+
+
+/**
+ * @brief Test if a simulated controller drives the given line (key or switch read).
+ * @param level Set to the level of the line if it is driven.
+ */
+bool VFD_HostPT6312::drivesPin(uint8_t port, uint8_t pin, bool &level)
+{
+    for (uint8_t i = 0; i < VFD_HOST_PT6312_MAX; i++) {
+        VFD_HostPT6312 *controller = controllers[i];
+        if (controller && controller->dataPort == port && controller->dataPin == pin
+            && controller->drivesData(level)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Virtual PT6312 controller wired to the virtual IO ports of the host backend.
+ * This file is included by host/host_hal.h.
+ */
+#ifndef VFD_PT6312_SIM_H
+#define VFD_PT6312_SIM_H
+
+#include "pt6312_model.h"
+
+// Max number of simulated controllers
+#define VFD_HOST_PT6312_MAX     4
+
+/**
+ * Virtual PT6312 controller (see VFD_PT6312Model) wired to the virtual IO ports.
+ *
+ * The controller is attached to the IO ports as long as the object exists.
+ * Times of the model (key script, power-up) are on the virtual clock (see VFD_hostNanos()).
+ *
+ * Ex:
+ *      VFD_HostPT6312 vfd(VFD_CS_PORT, VFD_CS_PIN, VFD_SCLK_PORT, VFD_SCLK_PIN,
+ *                         VFD_DATA_PORT, VFD_DATA_PIN);
+ *      VFD_initialize();
+ *      VFD_writeString("HELLO", false);
+ *      vfd.memory[0]...
+ */
+class VFD_HostPT6312 : public VFD_PT6312Model
+{
+public:
+    VFD_HostPT6312(VFD_HostRegister cs_port, uint8_t cs_pin,
+                   VFD_HostRegister sclk_port, uint8_t sclk_pin,
+                   VFD_HostRegister data_port, uint8_t data_pin);
+    ~VFD_HostPT6312();
+
+    // Power-on state
+    void reset(void);
+
+    // Called by the host backend
+    static void pinsChanged(void);
+    static bool drivesPin(uint8_t port, uint8_t pin, bool &level);
+
+private:
+    void sample(void);
+
+    static VFD_HostPT6312 *controllers[VFD_HOST_PT6312_MAX];
+
+    uint8_t csPort, csPin, sclkPort, sclkPin, dataPort, dataPin;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Background key scanner (see ENABLE_KEY_SCANNER in global.h).
+ *
+ * The key matrix is read by the timer interrupt at VFD_KEY_SCAN_FREQUENCY, debounced,
+ * and the changes are pushed as events in a queue emptied by the main program
+ * with VFD_readKeyEvent().
+ */
+#include "PT6312.h"
+
+#if ENABLE_KEY_SCANNER == 1
+
+#if ENABLE_TIMER != 1
+    #error "ENABLE_KEY_SCANNER requires ENABLE_TIMER!"
+#endif
+
+static_assert(VFD_KEY_SCAN_FREQUENCY > 0 && VFD_TIMER_FREQUENCY % VFD_KEY_SCAN_FREQUENCY == 0,
+              "VFD_KEY_SCAN_FREQUENCY must divide VFD_TIMER_FREQUENCY");
+static_assert(VFD_TIMER_FREQUENCY / VFD_KEY_SCAN_FREQUENCY <= 255,
+              "VFD_KEY_SCAN_FREQUENCY is too low for VFD_TIMER_FREQUENCY");
+static_assert(VFD_KEY_DEBOUNCE >= 1 && VFD_KEY_DEBOUNCE <= 255, "VFD_KEY_DEBOUNCE must be in 1..255");
+static_assert(VFD_KEY_EVENTS >= 2 && VFD_KEY_EVENTS <= 128 && (VFD_KEY_EVENTS & (VFD_KEY_EVENTS - 1)) == 0,
+              "VFD_KEY_EVENTS must be a power of 2 in 2..128");
+
+// Timer interrupts between 2 scans
+static constexpr uint8_t  VFD_KEY_SCAN_DIVIDER = VFD_TIMER_FREQUENCY / VFD_KEY_SCAN_FREQUENCY;
+// Delays converted in number of scans
+static constexpr uint16_t VFD_KEY_LONG_SCANS   = (uint32_t)VFD_KEY_LONG_PRESS * VFD_KEY_SCAN_FREQUENCY / 1000;
+static constexpr uint16_t VFD_KEY_REPEAT_SCANS = (uint32_t)VFD_KEY_REPEAT * VFD_KEY_SCAN_FREQUENCY / 1000;
+
+static_assert(VFD_KEY_LONG_SCANS >= 1 && (uint32_t)VFD_KEY_LONG_PRESS * VFD_KEY_SCAN_FREQUENCY / 1000 <= 65535UL,
+              "VFD_KEY_LONG_PRESS out of range for VFD_KEY_SCAN_FREQUENCY");
+static_assert(VFD_KEY_REPEAT == 0 || (VFD_KEY_REPEAT_SCANS >= 1
+              && (uint32_t)VFD_KEY_REPEAT * VFD_KEY_SCAN_FREQUENCY / 1000 <= 65535UL),
+              "VFD_KEY_REPEAT out of range for VFD_KEY_SCAN_FREQUENCY");
+
+/**
+ * State of the scanner, only modified by the timer interrupt (except on start)
+ * @see VFD_keyScannerStart()
+ */
+static struct {
+    volatile bool running;
+    uint8_t       tick;             // Timer interrupts since the last scan
+    uint32_t      sample;           // Last raw reading of the key matrix
+    uint8_t       stable_scans;     // Number of consecutive scans that returned sample
+    uint32_t      keys;             // Debounced keys
+    uint8_t       held_key;         // Last pressed key, still held (0: none)
+    uint16_t      held_scans;       // Number of scans since held_key was pressed
+} scanner;
+
+/**
+ * Queue of key events: single producer (timer interrupt), single consumer (main program).
+ * head is only written by the producer, tail by the consumer; a slot is kept
+ * empty to distinguish a full queue from an empty one.
+ */
+static struct {
+    uint8_t          buffer[VFD_KEY_EVENTS];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+} key_events;
+
+
+/**
+ * @brief Push an event in the queue; the event is lost if the queue is full.
+ */
+static void VFD_pushKeyEvent(uint8_t type, uint8_t key)
+{
+    uint8_t head = key_events.head;
+    uint8_t next = (head + 1) & (VFD_KEY_EVENTS - 1);
+
+    if (next == key_events.tail) {
+        return;
+    }
+    key_events.buffer[head] = type | key;
+    // Publish the event after it is written
+    key_events.head = next;
+}
+
+
+/**
+ * @brief Start the scan of the keys in background.
+ *      The key matrix is read by the timer interrupt at VFD_KEY_SCAN_FREQUENCY;
+ *      a change is accepted when VFD_KEY_DEBOUNCE consecutive scans return it.
+ *      The queue of events is emptied.
+ * @see VFD_readKeyEvent(), VFD_keyScannerStop()
+ */
+void VFD_keyScannerStart(void)
+{
+    scanner.running      = false;
+    scanner.tick         = 0;
+    scanner.sample       = 0;
+    scanner.stable_scans = 0;
+    scanner.keys         = 0;
+    scanner.held_key     = 0;
+    scanner.held_scans   = 0;
+    key_events.tail      = key_events.head;
+    scanner.running      = true;
+}
+
+
+/**
+ * @brief Stop the scan of the keys started with VFD_keyScannerStart().
+ *      Events not read stay in the queue.
+ */
+void VFD_keyScannerStop(void)
+{
+    scanner.running = false;
+}
+
+
+/**
+ * @brief Get the oldest key event emitted by the scanner.
+ *      Byte of an event:
+ *          - 2 most significant bits: type of event (VFD_KEY_EVENT_TYPE()):
+ *          VFD_KEY_EVENT_PRESS, VFD_KEY_EVENT_RELEASE,
+ *          VFD_KEY_EVENT_LONG: the key is held since VFD_KEY_LONG_PRESS ms,
+ *          VFD_KEY_EVENT_REPEAT: the key is still held, emitted every VFD_KEY_REPEAT ms
+ *          after the long press.
+ *          - 6 least significant bits: number of the key (VFD_KEY_EVENT_KEY()), from 1 to 24:
+ *          bit number + 1 in the value of VFD_getKeys(); keys 1 to 4 are the keys
+ *          of VFD_getKeyPressed().
+ *      Long press and repeat events are only emitted for the last pressed key.
+ *
+ *      Ex:
+ *          uint8_t event;
+ *          while (VFD_readKeyEvent(event)) {
+ *              if (VFD_KEY_EVENT_TYPE(event) == VFD_KEY_EVENT_PRESS && VFD_KEY_EVENT_KEY(event) == 1)
+ *                  ...
+ *          }
+ * @param event Set to the event if there is one.
+ * @return False if the queue is empty.
+ */
+bool VFD_readKeyEvent(uint8_t &event)
+{
+    uint8_t tail = key_events.tail;
+
+    if (tail == key_events.head) {
+        return false;
+    }
+    event = key_events.buffer[tail];
+    // Release the slot after it is read
+    key_events.tail = (tail + 1) & (VFD_KEY_EVENTS - 1);
+    return true;
+}
+
+
+/**
+ * @brief Scan the keys every VFD_TIMER_FREQUENCY / VFD_KEY_SCAN_FREQUENCY interrupts.
+ *      Called by the timer interrupt.
+ *      The scan is postponed to the next interrupt if the bus is in use by the main program.
+ */
+void VFD_keyScannerInterrupt(void)
+{
+    if (!scanner.running) {
+        return;
+    }
+
+    if (scanner.tick < VFD_KEY_SCAN_DIVIDER - 1) {
+        scanner.tick++;
+        return;
+    }
+    // A transmission is in progress
+    if (!VFD_busIdle()) {
+        return;
+    }
+    scanner.tick = 0;
+
+    uint32_t sample = VFD_Driver::getKeys();
+
+    // Debounce: the matrix must be stable for VFD_KEY_DEBOUNCE scans
+    if (sample != scanner.sample) {
+        scanner.sample       = sample;
+        scanner.stable_scans = 1;
+    }else if (scanner.stable_scans < VFD_KEY_DEBOUNCE) {
+        scanner.stable_scans++;
+    }
+
+    if (scanner.stable_scans == VFD_KEY_DEBOUNCE && sample != scanner.keys) {
+        uint32_t changes = sample ^ scanner.keys;
+        scanner.keys = sample;
+
+        for (uint8_t key = 1; changes; key++, changes >>= 1, sample >>= 1) {
+            if (!(changes & 1)) {
+                continue;
+            }
+            if (sample & 1) {
+                VFD_pushKeyEvent(VFD_KEY_EVENT_PRESS, key);
+                scanner.held_key   = key;
+                scanner.held_scans = 0;
+            }else{
+                VFD_pushKeyEvent(VFD_KEY_EVENT_RELEASE, key);
+                if (key == scanner.held_key) {
+                    scanner.held_key = 0;
+                }
+            }
+        }
+    }
+
+    if (!scanner.held_key) {
+        return;
+    }
+    // Long press, then repeats
+    if (!VFD_KEY_REPEAT_SCANS && scanner.held_scans == VFD_KEY_LONG_SCANS) {
+        // No repeat: the counter stays at the long press, it would emit it again once wrapped
+        return;
+    }
+    scanner.held_scans++;
+    if (scanner.held_scans == VFD_KEY_LONG_SCANS) {
+        VFD_pushKeyEvent(VFD_KEY_EVENT_LONG, scanner.held_key);
+    }else if (VFD_KEY_REPEAT_SCANS && scanner.held_scans == VFD_KEY_LONG_SCANS + VFD_KEY_REPEAT_SCANS) {
+        VFD_pushKeyEvent(VFD_KEY_EVENT_REPEAT, scanner.held_key);
+        scanner.held_scans = VFD_KEY_LONG_SCANS;
+    }
+}
+#endif
@@ -0,0 +1,323 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Linux backend: character device GPIO & spidev interfaces.
+ * Empty on the other targets.
+ */
+#include "../PT6312.h"
+
+#ifdef VFD_LINUX
+
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include <linux/spi/spidev.h>
+
+
+/**
+ * @brief Convert a mask of line offsets to a mask of indexes in the line request.
+ */
+static uint64_t VFD_chipIndexes(const VFD_LinuxGpioChip &chip, uint64_t lines)
+{
+    uint64_t indexes = 0;
+    for (uint8_t i = 0; i < chip.count; i++) {
+        if (lines & (1ULL << chip.offsets[i])) {
+            indexes |= (1ULL << i);
+        }
+    }
+    return indexes;
+}
+
+
+/**
+ * @brief Fill a configuration of the requested lines from their directions & output levels:
+ *      inputs pulled up, outputs at their levels.
+ */
+static void VFD_chipConfig(const VFD_LinuxGpioChip &chip, struct gpio_v2_line_config &config)
+{
+    memset(&config, 0, sizeof(config));
+    config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_BIAS_PULL_UP;
+    if (chip.outputs) {
+        config.num_attrs = 2;
+        config.attrs[0].attr.id    = GPIO_V2_LINE_ATTR_ID_FLAGS;
+        config.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+        config.attrs[0].mask       = chip.outputs;
+        config.attrs[1].attr.id     = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        config.attrs[1].attr.values = chip.levels;
+        config.attrs[1].mask        = chip.outputs;
+    }
+}
+
+
+static void VFD_chipConfigure(void *context, uint8_t line, bool output, bool level)
+{
+    VFD_LinuxGpioChip &chip = *(VFD_LinuxGpioChip *)context;
+    uint64_t index = VFD_chipIndexes(chip, 1ULL << line);
+
+    chip.outputs = output ? (chip.outputs | index) : (chip.outputs & ~index);
+    chip.levels  = level ? (chip.levels | index) : (chip.levels & ~index);
+
+    struct gpio_v2_line_config config;
+    VFD_chipConfig(chip, config);
+    if (ioctl(chip.fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0) {
+        chip.errors++;
+    }
+}
+
+
+static void VFD_chipSetLines(void *context, uint64_t mask, uint64_t levels)
+{
+    VFD_LinuxGpioChip &chip = *(VFD_LinuxGpioChip *)context;
+    struct gpio_v2_line_values values;
+
+    values.mask = VFD_chipIndexes(chip, mask) & chip.outputs;
+    values.bits = VFD_chipIndexes(chip, levels);
+    chip.levels = (chip.levels & ~values.mask) | (values.bits & values.mask);
+    if (ioctl(chip.fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0) {
+        chip.errors++;
+    }
+}
+
+
+static uint64_t VFD_chipGetLines(void *context, uint64_t mask)
+{
+    VFD_LinuxGpioChip &chip = *(VFD_LinuxGpioChip *)context;
+    struct gpio_v2_line_values values;
+
+    values.mask = VFD_chipIndexes(chip, mask);
+    values.bits = 0;
+    if (ioctl(chip.fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+        chip.errors++;
+        // Not read: pulled up
+        return mask;
+    }
+
+    uint64_t levels = 0;
+    for (uint8_t i = 0; i < chip.count; i++) {
+        if (values.bits & values.mask & (1ULL << i)) {
+            levels |= (1ULL << chip.offsets[i]);
+        }
+    }
+    return levels;
+}
+
+
+/**
+ * @brief Request lines of a GPIO chip; they are inputs pulled up until the driver
+ *      configures them (VFD_initialize()).
+ * @param path Path of the chip. Ex: "/dev/gpiochip0".
+ * @param lines Offsets of the lines on the chip (range 0..63): CS lines of all the
+ *      controllers, SCLK and DATA.
+ * @param count Number of lines (max VFD_LINUX_CHIP_LINES).
+ * @return false if the chip can't be opened or the lines can't be requested
+ *      (errno is set).
+ */
+bool VFD_linuxGpioChipOpen(VFD_LinuxGpioChip &chip, const char *path,
+                           const uint8_t *lines, uint8_t count)
+{
+    chip.fd      = -1;
+    chip.count   = 0;
+    chip.outputs = 0;
+    chip.levels  = 0;
+    chip.errors  = 0;
+
+    chip.gpio.configure = VFD_chipConfigure;
+    chip.gpio.setLines  = VFD_chipSetLines;
+    chip.gpio.getLines  = VFD_chipGetLines;
+    chip.gpio.transfer  = 0;
+    chip.gpio.context   = &chip;
+
+    if (count > VFD_LINUX_CHIP_LINES) {
+        return false;
+    }
+
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    for (uint8_t i = 0; i < count; i++) {
+        if (lines[i] >= VFD_LINUX_LINES) {
+            return false;
+        }
+        request.offsets[i] = lines[i];
+        chip.offsets[i]    = lines[i];
+    }
+    chip.count        = count;
+    request.num_lines = count;
+    strncpy(request.consumer, "PT6312", sizeof(request.consumer) - 1);
+    VFD_chipConfig(chip, request.config);
+
+    int chip_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (chip_fd < 0) {
+        return false;
+    }
+    int result = ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &request);
+    close(chip_fd);
+    if (result < 0) {
+        return false;
+    }
+
+    chip.fd = request.fd;
+    return true;
+}
+
+
+/**
+ * @brief Release the lines of the chip.
+ */
+void VFD_linuxGpioChipClose(VFD_LinuxGpioChip &chip)
+{
+    if (chip.fd >= 0) {
+        close(chip.fd);
+        chip.fd = -1;
+    }
+}
+
+
+/**
+ * @brief Mirror the bits of a byte (SPI controllers without SPI_LSB_FIRST).
+ */
+static inline uint8_t VFD_reverseBits(uint8_t value)
+{
+    value = (value >> 4) | (value << 4);
+    value = ((value & 0xCC) >> 2) | ((value & 0x33) << 2);
+    value = ((value & 0xAA) >> 1) | ((value & 0x55) << 1);
+    return value;
+}
+
+
+/**
+ * @brief Perform a transaction in a single SPI_IOC_MESSAGE ioctl: the bytes to send,
+ *      then the bytes to read after the 1us wait of the controller. CS stays asserted
+ *      after the message if the transaction is not released.
+ */
+static void VFD_spidevTransfer(void *context, const VFD_LinuxTransaction &transaction)
+{
+    VFD_LinuxSpidev &spi = *(VFD_LinuxSpidev *)context;
+    uint8_t device = transaction.csLine;
+
+    if (device >= VFD_LINUX_SPI_DEVICES || !(spi.opened & (1 << device))) {
+        spi.errors++;
+        return;
+    }
+    bool reversed = spi.reversed & (1 << device);
+
+    uint8_t tx[VFD_LINUX_TX_MAX];
+    uint8_t idle[VFD_LINUX_TX_MAX];
+    for (uint8_t i = 0; i < transaction.txLength; i++) {
+        tx[i] = reversed ? VFD_reverseBits(transaction.tx[i]) : transaction.tx[i];
+    }
+    // DATA line released (HIGH) during the reads
+    memset(idle, 0xFF, sizeof(idle));
+
+    struct spi_ioc_transfer transfers[2];
+    uint8_t count = 0;
+    memset(transfers, 0, sizeof(transfers));
+
+    if (transaction.txLength || !transaction.rxLength) {
+        transfers[count].tx_buf      = (uintptr_t)tx;
+        transfers[count].len         = transaction.txLength;
+        transfers[count].speed_hz    = spi.speed;
+        transfers[count].delay_usecs = transaction.rxLength ? 1 : 0;
+        count++;
+    }
+    if (transaction.rxLength) {
+        transfers[count].tx_buf   = (uintptr_t)idle;
+        transfers[count].rx_buf   = (uintptr_t)transaction.rx;
+        transfers[count].len      = transaction.rxLength;
+        transfers[count].speed_hz = spi.speed;
+        count++;
+    }
+    transfers[count - 1].cs_change = !transaction.release;
+
+    if (ioctl(spi.fds[device], SPI_IOC_MESSAGE(count), transfers) < 0) {
+        spi.errors++;
+        return;
+    }
+
+    if (reversed) {
+        for (uint8_t i = 0; i < transaction.rxLength; i++) {
+            transaction.rx[i] = VFD_reverseBits(transaction.rx[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief Open a spidev device: SPI mode 3, least significant bit first, 8 bits words,
+ *      SCLK at spi.speed.
+ * @param device Index of the device, used as CS line by the driver
+ *      (range 0..VFD_LINUX_SPI_DEVICES - 1).
+ * @param path Path of the device. Ex: "/dev/spidev0.0".
+ * @return false if the device can't be opened or configured (errno is set).
+ */
+bool VFD_linuxSpidevOpen(VFD_LinuxSpidev &spi, uint8_t device, const char *path)
+{
+    spi.gpio.configure = 0;
+    spi.gpio.setLines  = 0;
+    spi.gpio.getLines  = 0;
+    spi.gpio.transfer  = VFD_spidevTransfer;
+    spi.gpio.context   = &spi;
+
+    if (device >= VFD_LINUX_SPI_DEVICES) {
+        return false;
+    }
+
+    int fd = open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    uint8_t mode = SPI_MODE_3 | SPI_LSB_FIRST;
+    uint8_t bits = 8;
+    bool reversed = false;
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) {
+        // LSB first not supported by the SPI controller
+        mode = SPI_MODE_3;
+        reversed = true;
+        if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0) {
+            close(fd);
+            return false;
+        }
+    }
+    if (ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0
+        || ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &spi.speed) < 0) {
+        close(fd);
+        return false;
+    }
+
+    spi.fds[device] = fd;
+    spi.opened |= (1 << device);
+    spi.reversed = reversed ? (spi.reversed | (1 << device)) : (spi.reversed & ~(1 << device));
+    return true;
+}
+
+
+/**
+ * @brief Close the opened devices.
+ */
+void VFD_linuxSpidevClose(VFD_LinuxSpidev &spi)
+{
+    for (uint8_t device = 0; device < VFD_LINUX_SPI_DEVICES; device++) {
+        if (spi.opened & (1 << device)) {
+            close(spi.fds[device]);
+        }
+    }
+    spi.opened = 0;
+}
+
+#endif
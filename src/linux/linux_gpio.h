@@ -0,0 +1,99 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Kernel interfaces of the Linux backend: character device GPIO & spidev.
+ * This file is included by linux/linux_hal.h.
+ */
+#ifndef VFD_LINUX_GPIO_H
+#define VFD_LINUX_GPIO_H
+
+// Max number of lines requested on a GPIO chip
+#define VFD_LINUX_CHIP_LINES    16
+// Max number of spidev devices (chip selects)
+#define VFD_LINUX_SPI_DEVICES   4
+// Default SCLK frequency of spidev in Hz (max 1MHz for the controller)
+#define VFD_LINUX_SPI_SPEED     500000
+
+/**
+ * Lines of a GPIO chip (/dev/gpiochipN, GPIO v2 uAPI).
+ *
+ * The lines are requested together; each call of the interface is a single ioctl:
+ * the backend changes SCLK & DATA at once (2 ioctls per bit, the uAPI has no
+ * sequence of values).
+ *
+ * Ex:
+ *      static const uint8_t lines[] = {VFD_CS_LINE, VFD_SCLK_LINE, VFD_DATA_LINE};
+ *      VFD_LinuxGpioChip chip;
+ *      if (!VFD_linuxGpioChipOpen(chip, "/dev/gpiochip0", lines, 3)) ...
+ *      VFD_linuxSetGpio(&chip.gpio);
+ *      VFD_initialize();
+ */
+struct VFD_LinuxGpioChip
+{
+    // File descriptor of the line request (-1: closed)
+    int      fd;
+    uint8_t  count;
+    // Offsets of the requested lines, by index in the request
+    uint8_t  offsets[VFD_LINUX_CHIP_LINES];
+    // Directions & output levels, by index in the request
+    uint64_t outputs;
+    uint64_t levels;
+    // Failed ioctls
+    uint32_t errors;
+    // Interface to give to VFD_linuxSetGpio()
+    VFD_LinuxGpio gpio;
+};
+
+bool VFD_linuxGpioChipOpen(VFD_LinuxGpioChip &chip, const char *path,
+                           const uint8_t *lines, uint8_t count);
+void VFD_linuxGpioChipClose(VFD_LinuxGpioChip &chip);
+
+/**
+ * spidev devices (/dev/spidevB.C), SPI mode 3, least significant bit first.
+ *
+ * The devices are opened one by one in the same object (see speed before the opening).
+ * Each transaction is a single SPI_IOC_MESSAGE ioctl: CS is driven by the SPI
+ * controller, the CS "line" of the driver is the index of the device
+ * (0..VFD_LINUX_SPI_DEVICES - 1). Requires VFD_TRANSPORT_LINUX.
+ * If the SPI controller doesn't support SPI_LSB_FIRST, the bits are reversed by the library.
+ * Wiring: like VFD_TRANSPORT_SPI, MOSI to the DATA line through a resistor and MISO
+ * to the DATA line (MOSI sends 0xFF during the reads).
+ *
+ * Ex:
+ *      VFD_LinuxSpidev spi;
+ *      if (!VFD_linuxSpidevOpen(spi, 0, "/dev/spidev0.0")) ...
+ *      VFD_linuxSetGpio(&spi.gpio);
+ */
+struct VFD_LinuxSpidev
+{
+    int      fds[VFD_LINUX_SPI_DEVICES];
+    // Bit n: device n opened
+    uint8_t  opened = 0;
+    // Bit n: the bits are reversed by the library for device n
+    uint8_t  reversed = 0;
+    // SCLK frequency in Hz
+    uint32_t speed = VFD_LINUX_SPI_SPEED;
+    // Failed ioctls
+    uint32_t errors = 0;
+    // Interface to give to VFD_linuxSetGpio()
+    VFD_LinuxGpio gpio;
+};
+
+bool VFD_linuxSpidevOpen(VFD_LinuxSpidev &spi, uint8_t device, const char *path);
+void VFD_linuxSpidevClose(VFD_LinuxSpidev &spi);
+
+#endif
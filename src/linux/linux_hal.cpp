@@ -0,0 +1,390 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Linux backend: lines, transactions, clock and interrupts.
+ * Empty on the other targets.
+ */
+#include "../PT6312.h"
+
+#ifdef VFD_LINUX
+
+#include <time.h>
+
+#define VFD_LINE(line)  (1ULL << (line))
+
+static const VFD_LinuxGpio *vfd_linux_gpio;
+static uint32_t vfd_linux_calls;
+// Direction & output levels of the lines (like the DDR & PORT registers of the MCU)
+static uint64_t vfd_linux_outputs;
+static uint64_t vfd_linux_levels;
+
+// Transaction in progress (VFD_TRANSPORT_LINUX): bytes not sent yet
+static VFD_LinuxTransaction vfd_linux_transaction;
+static uint8_t  vfd_linux_tx[VFD_LINUX_TX_MAX];
+
+static bool     vfd_linux_interrupts = true;
+static bool     vfd_linux_in_interrupt;
+static void     (*vfd_linux_timer_interrupt)(void);
+static uint64_t vfd_linux_timer_period;
+static uint64_t vfd_linux_timer_next;
+
+
+/**
+ * @brief Set the interface to the GPIO lines; must be called before VFD_initialize().
+ * @param gpio Interface (Ex: filled by VFD_linuxGpioChipOpen()); must stay valid
+ *      while the library is used.
+ */
+void VFD_linuxSetGpio(const VFD_LinuxGpio *gpio)
+{
+    vfd_linux_gpio = gpio;
+}
+
+
+/**
+ * @return Number of calls made to the interface since the start of the program
+ *      (ioctls for the kernel interfaces).
+ */
+uint32_t VFD_linuxGpioCalls(void)
+{
+    return vfd_linux_calls;
+}
+
+
+static void VFD_linuxConfigure(uint8_t line, bool output, bool level)
+{
+    if (vfd_linux_gpio && vfd_linux_gpio->configure) {
+        vfd_linux_calls++;
+        vfd_linux_gpio->configure(vfd_linux_gpio->context, line, output, level);
+    }
+}
+
+
+static void VFD_linuxSetLines(uint64_t mask, uint64_t levels)
+{
+    if (vfd_linux_gpio && vfd_linux_gpio->setLines) {
+        vfd_linux_calls++;
+        vfd_linux_gpio->setLines(vfd_linux_gpio->context, mask, levels);
+    }
+}
+
+
+static uint64_t VFD_linuxGetLines(uint64_t mask)
+{
+    if (vfd_linux_gpio && vfd_linux_gpio->getLines) {
+        vfd_linux_calls++;
+        return vfd_linux_gpio->getLines(vfd_linux_gpio->context, mask);
+    }
+    // Not driven: pulled up
+    return mask;
+}
+
+
+/**
+ * @brief Set the direction of a line (pinMode()); nothing is done if it is unchanged.
+ *      An output takes the level set by VFD_linuxLineWrite(), an input is pulled up.
+ */
+void VFD_linuxLineOutput(uint8_t line, bool output)
+{
+    if (!(vfd_linux_outputs & VFD_LINE(line)) == !output) {
+        return;
+    }
+    vfd_linux_outputs ^= VFD_LINE(line);
+    VFD_linuxConfigure(line, output, vfd_linux_levels & VFD_LINE(line));
+}
+
+
+/**
+ * @brief Set the level of a line (digitalWrite()); sent if the line is an output
+ *      and the level changed.
+ */
+void VFD_linuxLineWrite(uint8_t line, bool level)
+{
+    if (!(vfd_linux_levels & VFD_LINE(line)) == !level) {
+        return;
+    }
+    vfd_linux_levels ^= VFD_LINE(line);
+    if (vfd_linux_outputs & VFD_LINE(line)) {
+        VFD_linuxSetLines(VFD_LINE(line), vfd_linux_levels);
+    }
+}
+
+
+/**
+ * @return Level set by VFD_linuxLineWrite(), or by the transactions for a CS line.
+ */
+bool VFD_linuxLineIsHigh(uint8_t line)
+{
+    return vfd_linux_levels & VFD_LINE(line);
+}
+
+
+/**
+ * @return Level read on the line (the level set for an output).
+ */
+bool VFD_linuxLineRead(uint8_t line)
+{
+    if (vfd_linux_outputs & VFD_LINE(line)) {
+        return vfd_linux_levels & VFD_LINE(line);
+    }
+    return VFD_linuxGetLines(VFD_LINE(line));
+}
+
+
+/**
+ * @brief Perform a transaction with setLines()/getLines(), for the interfaces
+ *      without transfer(). Same timings as the bit-banged transport of the driver;
+ *      SCLK falling edge & DATA are set in the same call: 2 calls per bit.
+ */
+static void VFD_linuxBitbang(const VFD_LinuxTransaction &t)
+{
+    const uint64_t cs   = VFD_LINE(t.csLine);
+    const uint64_t sclk = VFD_LINE(t.sclkLine);
+    const uint64_t data = VFD_LINE(t.dataLine);
+
+    if (!t.continued) {
+        VFD_linuxSetLines(cs, 0);
+        VFD_linuxSpin(1000);
+    }
+
+    for (uint8_t i = 0; i < t.txLength; i++) {
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            // Data is read at the rising edge
+            VFD_linuxSetLines(sclk | data, ((t.tx[i] >> bit) & 1) ? data : 0);
+            VFD_linuxSpin(500);
+            VFD_linuxSetLines(sclk, sclk);
+            VFD_linuxSpin(500);
+        }
+        vfd_linux_levels = (vfd_linux_levels & ~data) | ((t.tx[i] & 0x80) ? data : 0);
+    }
+
+    if (t.rxLength) {
+        // The controller drives the DATA line
+        VFD_linuxConfigure(t.dataLine, false, true);
+        VFD_linuxSpin(1000);
+
+        for (uint8_t i = 0; i < t.rxLength; i++) {
+            uint8_t value = 0xFF;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                VFD_linuxSetLines(sclk, 0);
+                VFD_linuxSpin(500);
+                // Data is read at the falling edge
+                if (!VFD_linuxGetLines(data)) {
+                    value &= ~(1 << bit);
+                }
+                VFD_linuxSetLines(sclk, sclk);
+                VFD_linuxSpin(500);
+            }
+            t.rx[i] = value;
+        }
+
+        VFD_linuxConfigure(t.dataLine, true, true);
+        vfd_linux_levels |= data;
+    }
+
+    if (t.release) {
+        VFD_linuxSpin(1000);
+        VFD_linuxSetLines(cs, cs);
+        VFD_linuxSpin(1000);
+    }
+}
+
+
+/**
+ * @brief Pass the pending bytes of the transaction (and the bytes to read) to the interface.
+ * @param release End of the transaction (CS HIGH).
+ */
+static void VFD_linuxRun(uint8_t *rx, uint8_t rx_length, bool release)
+{
+    VFD_LinuxTransaction &t = vfd_linux_transaction;
+
+    t.tx       = vfd_linux_tx;
+    t.rx       = rx;
+    t.rxLength = rx_length;
+    t.release  = release;
+
+    if (vfd_linux_gpio && vfd_linux_gpio->transfer) {
+        vfd_linux_calls++;
+        vfd_linux_gpio->transfer(vfd_linux_gpio->context, t);
+    }else{
+        VFD_linuxBitbang(t);
+    }
+
+    t.continued = !release;
+    t.txLength  = 0;
+}
+
+
+/**
+ * @brief Step of a transmission of the driver with VFD_TRANSPORT_LINUX (see PT6312::txSend()).
+ *      The bytes are kept until the end of the transmission (VFD_TX_END), then the whole
+ *      transaction is passed to the interface. Longer transmissions than VFD_LINUX_TX_MAX
+ *      are passed in several parts, CS staying LOW.
+ *      The CS line reads LOW (VFD_linuxLineIsHigh()) from the start of the transmission.
+ * @param cs_line, sclk_line, data_line Lines of the controller.
+ * @param value Byte to send (if VFD_TX_DATA is set).
+ * @param flags Combination of VFD_TX_START, VFD_TX_DATA and VFD_TX_END.
+ */
+void VFD_linuxTransmit(uint8_t cs_line, uint8_t sclk_line, uint8_t data_line,
+                       uint8_t value, uint8_t flags)
+{
+    VFD_LinuxTransaction &t = vfd_linux_transaction;
+
+    if (flags & VFD_TX_START) {
+        t.csLine    = cs_line;
+        t.sclkLine  = sclk_line;
+        t.dataLine  = data_line;
+        t.continued = false;
+        t.txLength  = 0;
+        vfd_linux_levels &= ~VFD_LINE(cs_line);
+    }
+    if (flags & VFD_TX_DATA) {
+        if (t.txLength == VFD_LINUX_TX_MAX) {
+            VFD_linuxRun(0, 0, false);
+        }
+        vfd_linux_tx[t.txLength++] = value;
+    }
+    if (flags & VFD_TX_END) {
+        if (t.txLength || t.continued) {
+            VFD_linuxRun(0, 0, true);
+        }
+        vfd_linux_levels |= VFD_LINE(cs_line);
+    }
+}
+
+
+/**
+ * @brief Read bytes in the transmission in progress (key/switch read command sent):
+ *      the pending bytes and the read are passed to the interface in a single call.
+ * @param data Buffer of the bytes read.
+ * @param length Number of bytes to read.
+ * @param release End of the transaction after the read (CS HIGH); the end of the
+ *      transmission (VFD_TX_END) is then ignored.
+ */
+void VFD_linuxReceive(uint8_t *data, uint8_t length, bool release)
+{
+    VFD_linuxRun(data, length, release);
+}
+
+
+/**
+ * @return Nanoseconds elapsed since the first call (monotonic clock).
+ */
+uint64_t VFD_linuxNanos(void)
+{
+    static uint64_t start;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t nanos = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    if (!start) {
+        start = nanos;
+    }
+    return nanos - start;
+}
+
+
+/**
+ * @brief Busy wait; the timer interrupt is not called (transactions of the backend).
+ */
+void VFD_linuxSpin(uint64_t nanoseconds)
+{
+    uint64_t end = VFD_linuxNanos() + nanoseconds;
+
+    while (VFD_linuxNanos() < end) {
+    }
+}
+
+
+/**
+ * @brief Wait the given time; the timer interrupt is called at each of its periods
+ *      in the delay. The process sleeps if the wait is longer than VFD_LINUX_SLEEP_MIN.
+ */
+void VFD_linuxDelay(uint64_t nanoseconds)
+{
+    uint64_t end = VFD_linuxNanos() + nanoseconds;
+
+    for (;;) {
+        VFD_linuxPoll();
+
+        uint64_t now = VFD_linuxNanos();
+        if (now >= end) {
+            return;
+        }
+
+        uint64_t wait = end - now;
+        if (vfd_linux_timer_interrupt && vfd_linux_interrupts && !vfd_linux_in_interrupt
+            && vfd_linux_timer_next < end) {
+            wait = (vfd_linux_timer_next > now) ? vfd_linux_timer_next - now : 0;
+        }
+        if (wait >= VFD_LINUX_SLEEP_MIN) {
+            struct timespec duration;
+            duration.tv_sec  = wait / 1000000000ULL;
+            duration.tv_nsec = wait % 1000000000ULL;
+            nanosleep(&duration, 0);
+        }
+    }
+}
+
+
+/**
+ * @brief Call the timer interrupt if its period is elapsed and the interrupts are enabled.
+ *      Periods missed by the main program are merged.
+ */
+void VFD_linuxPoll(void)
+{
+    if (!vfd_linux_timer_interrupt || !vfd_linux_interrupts || vfd_linux_in_interrupt) {
+        return;
+    }
+
+    uint64_t now = VFD_linuxNanos();
+    if (now < vfd_linux_timer_next) {
+        return;
+    }
+
+    vfd_linux_in_interrupt = true;
+    vfd_linux_timer_interrupt();
+    vfd_linux_in_interrupt = false;
+
+    vfd_linux_timer_next += vfd_linux_timer_period;
+    if (vfd_linux_timer_next <= now) {
+        vfd_linux_timer_next = now + vfd_linux_timer_period;
+    }
+}
+
+
+/**
+ * @brief Enable or disable the interrupts (sei(), cli()).
+ */
+void VFD_linuxInterrupts(bool enabled)
+{
+    vfd_linux_interrupts = enabled;
+}
+
+
+/**
+ * @brief Start a periodic interrupt.
+ * @param interrupt Function to call.
+ * @param period Period in nanoseconds.
+ */
+void VFD_linuxTimerStart(void (*interrupt)(void), uint64_t period)
+{
+    vfd_linux_timer_interrupt = interrupt;
+    vfd_linux_timer_period    = period;
+    vfd_linux_timer_next      = VFD_linuxNanos() + period;
+}
+
+#endif
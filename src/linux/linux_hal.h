@@ -0,0 +1,164 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Linux backend of the hardware abstraction: userspace driver for single-board computers.
+ *
+ * - The pins are GPIO lines (see VFD_DEFINE_LINE_PIN() in pins.h), accessed through
+ *   a pluggable interface (VFD_LinuxGpio): character device GPIO (gpiochip),
+ *   spidev, or the in-process mock chip (see linux_mock.h).
+ * - With VFD_TRANSPORT_LINUX, the driver hands whole transactions (CS LOW .. CS HIGH)
+ *   to the backend, which passes each one to the interface in a single call
+ *   (one ioctl for spidev).
+ * - Delays use the monotonic clock (busy wait below VFD_LINUX_SLEEP_MIN).
+ * - The timer interrupt is called by the delays and by VFD_linuxPoll() when its
+ *   period is elapsed, if the interrupts are enabled: it never runs concurrently
+ *   with the main program, like on the MCU.
+ * - PROGMEM data stays in RAM.
+ *
+ * This file is included by hal.h when VFD_LINUX is defined (Ex: -DVFD_LINUX).
+ */
+#ifndef VFD_LINUX_HAL_H
+#define VFD_LINUX_HAL_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+// Max number of lines of an interface: line offsets are in range 0..63
+#define VFD_LINUX_LINES         64
+// Max number of bytes sent in a single call (command + display memory)
+#define VFD_LINUX_TX_MAX        32
+// Shorter delays are busy waits (in nanoseconds)
+#define VFD_LINUX_SLEEP_MIN     100000
+
+/**
+ * Transaction with a controller: CS LOW, txLength bytes sent, rxLength bytes read,
+ * then CS HIGH if release is set. Bits are sent least significant bit first,
+ * latched by the controller on the rising edges of SCLK (SPI mode 3).
+ */
+struct VFD_LinuxTransaction
+{
+    uint8_t        csLine;
+    uint8_t        sclkLine;
+    uint8_t        dataLine;
+    // CS is already LOW: continuation of a transaction that was not released
+    bool           continued;
+    const uint8_t *tx;
+    uint8_t        txLength;
+    uint8_t       *rx;
+    uint8_t        rxLength;
+    bool           release;
+};
+
+/**
+ * Interface to the GPIO lines of the controllers.
+ * Masks and levels: bit n for the line of offset n.
+ * The implementations count their errors (Ex: VFD_LinuxGpioChip::errors), the library
+ * doesn't check them.
+ * All the functions are optional (NULL):
+ *      - without configure(), setLines(), getLines(): the lines belong to the
+ *        transfer() implementation (Ex: spidev), VFD_TRANSPORT_LINUX is required;
+ *      - without transfer(): the transactions are bit-banged by the backend with
+ *        setLines()/getLines(), SCLK & DATA changed in the same call.
+ */
+struct VFD_LinuxGpio
+{
+    // Configure a line: output at the given level, or input pulled up
+    void (*configure)(void *context, uint8_t line, bool output, bool level);
+    // Set the levels of the output lines of the mask, in a single call
+    void (*setLines)(void *context, uint64_t mask, uint64_t levels);
+    // Read the levels of the lines of the mask, in a single call
+    uint64_t (*getLines)(void *context, uint64_t mask);
+    // Perform a whole transaction, in a single call
+    void (*transfer)(void *context, const VFD_LinuxTransaction &transaction);
+    // Given to the functions above
+    void *context;
+};
+
+void VFD_linuxSetGpio(const VFD_LinuxGpio *gpio);
+// Number of calls made to the interface since the start of the program
+uint32_t VFD_linuxGpioCalls(void);
+
+/**
+ * Lines (pins of the driver, see VFD_DEFINE_LINE_PIN())
+ * The levels of the outputs are kept by the backend: isHigh() doesn't access the interface.
+ */
+void VFD_linuxLineOutput(uint8_t line, bool output);
+void VFD_linuxLineWrite(uint8_t line, bool level);
+bool VFD_linuxLineIsHigh(uint8_t line);
+bool VFD_linuxLineRead(uint8_t line);
+
+/**
+ * Transactions of VFD_TRANSPORT_LINUX (used by the driver, see PT6312::txSend())
+ */
+void VFD_linuxTransmit(uint8_t cs_line, uint8_t sclk_line, uint8_t data_line,
+                       uint8_t value, uint8_t flags);
+void VFD_linuxReceive(uint8_t *data, uint8_t length, bool release);
+
+/**
+ * Clock & delays
+ */
+// Nanoseconds elapsed since the start of the program (monotonic clock)
+uint64_t VFD_linuxNanos(void);
+void VFD_linuxDelay(uint64_t nanoseconds);
+// Busy wait, the timer interrupt is not called
+void VFD_linuxSpin(uint64_t nanoseconds);
+// Call the timer interrupt if its period is elapsed; to call in the main loop
+void VFD_linuxPoll(void);
+
+static inline void _delay_us(double us)
+{
+    VFD_linuxDelay((uint64_t)(us * 1000.0));
+}
+
+static inline void _delay_ms(double ms)
+{
+    VFD_linuxDelay((uint64_t)(ms * 1000000.0));
+}
+
+/**
+ * Flash memory: data stays in RAM
+ */
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const uint8_t *)(address))
+#define pgm_read_word(address)  (*(const uint16_t *)(address))
+
+/**
+ * Interrupts
+ */
+void VFD_linuxInterrupts(bool enabled);
+// Call the given function every period (in nanoseconds) while interrupts are enabled
+void VFD_linuxTimerStart(void (*interrupt)(void), uint64_t period);
+
+#define sei()   VFD_linuxInterrupts(true)
+#define cli()   VFD_linuxInterrupts(false)
+// The timer interrupt never preempts the main program: the atomic blocks are plain blocks
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_BLOCK(type)  for (bool vfd_atomic = true; vfd_atomic; vfd_atomic = false)
+#define ISR(vector) \
+    extern "C" void vector(void); \
+    extern "C" void vector(void)
+
+// Vector of the timer interrupt of the library (see timer.cpp)
+extern "C" void VFD_LINUX_TIMER_vect(void);
+
+#include "linux_gpio.h"
+#include "linux_mock.h"
+
+#endif
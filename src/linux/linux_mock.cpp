@@ -0,0 +1,181 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Linux backend: mock GPIO chip.
+ * Empty on the other targets.
+ */
+#include "../PT6312.h"
+
+#ifdef VFD_LINUX
+
+#define VFD_LINE(line)  (1ULL << (line))
+
+
+/**
+ * @param spi Behave like spidev (transfer() only) instead of a gpiochip.
+ */
+VFD_LinuxMockChip::VFD_LinuxMockChip(bool spi)
+    : outputs(0), levels(0), count(0)
+{
+    gpio.configure = spi ? 0 : configure;
+    gpio.setLines  = spi ? 0 : setLines;
+    gpio.getLines  = spi ? 0 : getLines;
+    gpio.transfer  = spi ? transfer : 0;
+    gpio.context   = this;
+}
+
+
+void VFD_LinuxMockChip::attach(VFD_PT6312Model &controller, uint8_t cs_line,
+                               uint8_t sclk_line, uint8_t data_line)
+{
+    if (count == VFD_LINUX_MOCK_MAX) {
+        return;
+    }
+    wirings[count].controller = &controller;
+    wirings[count].csLine     = cs_line;
+    wirings[count].sclkLine   = sclk_line;
+    wirings[count].dataLine   = data_line;
+    count++;
+
+    if (!gpio.configure) {
+        // Lines of the SPI controller: idle levels
+        outputs |= VFD_LINE(cs_line) | VFD_LINE(sclk_line) | VFD_LINE(data_line);
+        levels  |= VFD_LINE(cs_line) | VFD_LINE(sclk_line) | VFD_LINE(data_line);
+    }
+}
+
+
+bool VFD_LinuxMockChip::level(uint8_t line) const
+{
+    if (outputs & VFD_LINE(line)) {
+        return levels & VFD_LINE(line);
+    }
+    bool driven;
+    for (uint8_t i = 0; i < count; i++) {
+        if (wirings[i].dataLine == line && wirings[i].controller->drivesData(driven)) {
+            return driven;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * @brief Set levels of the lines and forward them to the controllers.
+ */
+void VFD_LinuxMockChip::drive(uint64_t mask, uint64_t values)
+{
+    levels = (levels & ~mask) | (values & mask);
+    update();
+}
+
+
+void VFD_LinuxMockChip::update(void)
+{
+    uint64_t now = VFD_linuxNanos();
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Wiring &wiring = wirings[i];
+        wiring.controller->sample(level(wiring.csLine), level(wiring.sclkLine),
+                                  level(wiring.dataLine), now);
+    }
+}
+
+
+void VFD_LinuxMockChip::configure(void *context, uint8_t line, bool output, bool level)
+{
+    VFD_LinuxMockChip &chip = *(VFD_LinuxMockChip *)context;
+
+    chip.outputs = output ? (chip.outputs | VFD_LINE(line)) : (chip.outputs & ~VFD_LINE(line));
+    chip.drive(VFD_LINE(line), level ? VFD_LINE(line) : 0);
+}
+
+
+void VFD_LinuxMockChip::setLines(void *context, uint64_t mask, uint64_t levels)
+{
+    VFD_LinuxMockChip &chip = *(VFD_LinuxMockChip *)context;
+
+    chip.drive(mask & chip.outputs, levels);
+}
+
+
+uint64_t VFD_LinuxMockChip::getLines(void *context, uint64_t mask)
+{
+    VFD_LinuxMockChip &chip = *(VFD_LinuxMockChip *)context;
+    uint64_t values = 0;
+
+    for (uint8_t line = 0; line < VFD_LINUX_LINES; line++) {
+        if ((mask & VFD_LINE(line)) && chip.level(line)) {
+            values |= VFD_LINE(line);
+        }
+    }
+    return values;
+}
+
+
+/**
+ * @brief Shift a transaction on the lines like a SPI controller in mode 3
+ *      (no delays: the controllers are sampled at each edge).
+ */
+void VFD_LinuxMockChip::transfer(void *context, const VFD_LinuxTransaction &transaction)
+{
+    VFD_LinuxMockChip &chip = *(VFD_LinuxMockChip *)context;
+
+    uint8_t index = 0;
+    while (index < chip.count && chip.wirings[index].csLine != transaction.csLine) {
+        index++;
+    }
+    if (index == chip.count) {
+        return;
+    }
+    const Wiring &wiring = chip.wirings[index];
+    const uint64_t cs   = VFD_LINE(wiring.csLine);
+    const uint64_t sclk = VFD_LINE(wiring.sclkLine);
+    const uint64_t data = VFD_LINE(wiring.dataLine);
+
+    if (!transaction.continued) {
+        chip.drive(cs, 0);
+    }
+    for (uint8_t i = 0; i < transaction.txLength; i++) {
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            chip.drive(sclk | data, ((transaction.tx[i] >> bit) & 1) ? data : 0);
+            chip.drive(sclk, sclk);
+        }
+    }
+    if (transaction.rxLength) {
+        // MOSI at 0xFF through its resistor: the controller drives the DATA line
+        chip.outputs &= ~data;
+        for (uint8_t i = 0; i < transaction.rxLength; i++) {
+            uint8_t value = 0;
+            for (uint8_t bit = 0; bit < 8; bit++) {
+                chip.drive(sclk, 0);
+                if (chip.level(wiring.dataLine)) {
+                    value |= (1 << bit);
+                }
+                chip.drive(sclk, sclk);
+            }
+            transaction.rx[i] = value;
+        }
+        chip.outputs |= data;
+        chip.drive(data, data);
+    }
+    if (transaction.release) {
+        chip.drive(cs, cs);
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Mock GPIO chip of the Linux backend: PT6312 models wired to in-process lines,
+ * to run & test the backend without hardware.
+ * This file is included by linux/linux_hal.h.
+ */
+#ifndef VFD_LINUX_MOCK_H
+#define VFD_LINUX_MOCK_H
+
+#include "../host/pt6312_model.h"
+
+// Max number of controllers wired to a mock chip
+#define VFD_LINUX_MOCK_MAX      4
+
+/**
+ * Mock GPIO chip.
+ *
+ * Like a gpiochip (default), the interface exposes the lines: the transactions are
+ * bit-banged by the backend. Like spidev (spi set), it only exposes transfer():
+ * the chip shifts the bytes on its lines itself, a transaction is a single call.
+ * Times of the models (key script, power-up) are on the clock of the backend
+ * (see VFD_linuxNanos()).
+ *
+ * Ex:
+ *      VFD_PT6312Model vfd;
+ *      VFD_LinuxMockChip chip;
+ *      chip.attach(vfd, VFD_CS_LINE, VFD_SCLK_LINE, VFD_DATA_LINE);
+ *      VFD_linuxSetGpio(&chip.gpio);
+ *      VFD_initialize();
+ *      VFD_writeString("HELLO", false);
+ *      vfd.gridSegments(1)...
+ */
+class VFD_LinuxMockChip
+{
+public:
+    explicit VFD_LinuxMockChip(bool spi = false);
+
+    // Wire a controller (max VFD_LINUX_MOCK_MAX)
+    void attach(VFD_PT6312Model &controller, uint8_t cs_line, uint8_t sclk_line, uint8_t data_line);
+    // Level of a line: set by the program (output), driven by a controller or pulled up (input)
+    bool level(uint8_t line) const;
+
+    // Interface to give to VFD_linuxSetGpio()
+    VFD_LinuxGpio gpio;
+    // Directions & output levels of the lines (bit n: line n)
+    uint64_t outputs;
+    uint64_t levels;
+
+private:
+    static void configure(void *context, uint8_t line, bool output, bool level);
+    static void setLines(void *context, uint64_t mask, uint64_t levels);
+    static uint64_t getLines(void *context, uint64_t mask);
+    static void transfer(void *context, const VFD_LinuxTransaction &transaction);
+
+    void drive(uint64_t mask, uint64_t levels);
+    void update(void);
+
+    struct Wiring
+    {
+        VFD_PT6312Model *controller;
+        uint8_t csLine, sclkLine, dataLine;
+    };
+    Wiring  wirings[VFD_LINUX_MOCK_MAX];
+    uint8_t count;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Pins of the MCU as types, used as template parameters of the PT6312 driver.
+ */
+#ifndef PINS_H
+#define PINS_H
+
+#include "hal.h"
+
+/**
+ * Define a pin type from its registers.
+ * All the operations are resolved at compile time to constant port/bit
+ * operations (sbi/cbi/sbis instructions for the IO registers).
+ * @param NAME Name of the type.
+ * @param DDR Data direction register. Ex: DDRB.
+ * @param PORT Output register. Ex: PORTB.
+ * @param PIN_REG Input register. Ex: PINB.
+ * @param BIT Bit number in the registers. Ex: PB0.
+ */
+#define VFD_DEFINE_PIN(NAME, DDR, PORT, PIN_REG, BIT)                    \
+    struct NAME                                                          \
+    {                                                                    \
+        static inline void output(void) { (DDR) |= (1 << (BIT)); }       \
+        static inline void input(void)  { (DDR) &= ~(1 << (BIT)); }      \
+        static inline void high(void)   { (PORT) |= (1 << (BIT)); }      \
+        static inline void low(void)    { (PORT) &= ~(1 << (BIT)); }     \
+        /* Output level set by high()/low() */                           \
+        static inline bool isHigh(void) { return bit_is_set(PORT, BIT); } \
+        /* Level read on the pin */                                      \
+        static inline bool read(void)   { return bit_is_set(PIN_REG, BIT); } \
+    }
+
+/**
+ * Define a pin type from its port letter and bit number.
+ * Ex: VFD_DEFINE_PORT_PIN(CsPin, B, 3) for PB3.
+ */
+#define VFD_DEFINE_PORT_PIN(NAME, LETTER, BIT) \
+    VFD_DEFINE_PIN(NAME, DDR##LETTER, PORT##LETTER, PIN##LETTER, BIT)
+
+#ifdef VFD_LINUX
+/**
+ * Define a pin type from a GPIO line (Linux backend, see linux/linux_hal.h).
+ * Ex: VFD_DEFINE_LINE_PIN(CsPin, 17) for the line of offset 17 of the chip.
+ * @param NAME Name of the type.
+ * @param LINE Offset of the line (range 0..63); index of the device with spidev.
+ */
+#define VFD_DEFINE_LINE_PIN(NAME, LINE)                                          \
+    struct NAME                                                                  \
+    {                                                                            \
+        static constexpr uint8_t line = (LINE);                                  \
+        static inline void output(void) { VFD_linuxLineOutput(line, true); }     \
+        static inline void input(void)  { VFD_linuxLineOutput(line, false); }    \
+        static inline void high(void)   { VFD_linuxLineWrite(line, true); }      \
+        static inline void low(void)    { VFD_linuxLineWrite(line, false); }     \
+        /* Output level set by high()/low() */                                   \
+        static inline bool isHigh(void) { return VFD_linuxLineIsHigh(line); }    \
+        /* Level read on the line */                                             \
+        static inline bool read(void)   { return VFD_linuxLineRead(line); }      \
+    }
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Tables computed at compile time and stored in flash.
+ */
+#ifndef PROGMEM_TABLE_H
+#define PROGMEM_TABLE_H
+
+#include <stdint.h>
+#include "hal.h"
+
+/**
+ * Sequence of integers 0..N-1 (no STL on AVR).
+ */
+template<uint16_t... Is> struct VFD_IndexSequence {};
+
+template<uint16_t N, uint16_t... Is>
+struct VFD_MakeIndexSequence : VFD_MakeIndexSequence<N - 1, N - 1, Is...> {};
+
+template<uint16_t... Is>
+struct VFD_MakeIndexSequence<0, Is...>
+{
+    typedef VFD_IndexSequence<Is...> type;
+};
+
+
+/**
+ * Array of N values stored in flash (PROGMEM), filled at compile time.
+ * @tparam Generator Type with:
+ *      - a value_type typedef,
+ *      - a static constexpr value_type value(uint16_t index) function.
+ * @tparam N Number of values.
+ * Ex: VFD_ProgmemTable<MyGenerator, 10>::values[i] with pgm_read_byte()/pgm_read_word().
+ */
+template<class Generator, class Sequence> struct VFD_ProgmemTableImpl;
+
+template<class Generator, uint16_t... Is>
+struct VFD_ProgmemTableImpl<Generator, VFD_IndexSequence<Is...> >
+{
+    static const typename Generator::value_type values[sizeof...(Is)];
+};
+
+template<class Generator, uint16_t... Is>
+const typename Generator::value_type
+VFD_ProgmemTableImpl<Generator, VFD_IndexSequence<Is...> >::values[sizeof...(Is)] PROGMEM = {
+    Generator::value(Is)...
+};
+
+template<class Generator, uint16_t N>
+struct VFD_ProgmemTable : VFD_ProgmemTableImpl<Generator, typename VFD_MakeIndexSequence<N>::type> {};
+
+#endif
@@ -0,0 +1,153 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Frames of the busy spinning circle computed at compile time.
+ */
+#ifndef SPINNER_TABLE_H
+#define SPINNER_TABLE_H
+
+#include "progmem_table.h"
+
+/**
+ * Duty cycles of the segments that follow the main segment of a frame.
+ * Ex: VFD_SpinnerDuty<2, 5, 12>: the 1st segment behind the main one is lit 1 refresh
+ * out of 2, the 2nd 1 out of 5, the 3rd 1 out of 12.
+ */
+template<uint8_t... DutyCycles> struct VFD_SpinnerDuty {};
+
+
+/**
+ * @return Bit k is set if the k-th fading segment is lit at the given refresh.
+ */
+static constexpr uint8_t VFD_spinnerFadeFlags(uint8_t, uint8_t)
+{
+    return 0;
+}
+
+template<typename... Duties>
+static constexpr uint8_t VFD_spinnerFadeFlags(uint8_t loop_number, uint8_t bit, uint8_t duty_cycle, Duties... duty_cycles)
+{
+    return (((loop_number % duty_cycle) == 0) ? (1 << bit) : 0)
+           | VFD_spinnerFadeFlags(loop_number, bit + 1, duty_cycles...);
+}
+
+
+/**
+ * @return The index-th segment of the list (0 if the index is out of range).
+ */
+static constexpr uint8_t VFD_spinnerSegmentAt(uint8_t)
+{
+    return 0;
+}
+
+template<typename... Segments>
+static constexpr uint8_t VFD_spinnerSegmentAt(uint8_t index, uint8_t segment, Segments... segments)
+{
+    return (index == 0) ? segment : VFD_spinnerSegmentAt(index - 1, segments...);
+}
+
+
+/**
+ * Frames of a busy spinning circle.
+ *
+ * Segments are successively displayed with 100% of the duty cycle of 1 frame;
+ * the segments that precede the main displayed segment are fading according to
+ * their duty cycles (the first frame has no fading segment).
+ *
+ * 2 tables are generated in flash:
+ *      - for each refresh of a frame, the fading segments that are lit (1 byte each);
+ *      - for each frame and each combination of fading segments, the 16 bits word of
+ *        segments (bits 0..15 for segments 1..16).
+ *
+ * @tparam Loops Number of refreshes of a frame.
+ * @tparam Duty VFD_SpinnerDuty of the fading segments.
+ * @tparam Segments Segment numbers (starting from 1) in order of display.
+ * Ex: VFD_SpinnerTable<70, VFD_SpinnerDuty<2, 5, 12>, 11, 12, 13, 14, 15, 16>
+ */
+template<uint8_t Loops, class Duty, uint8_t... Segments> class VFD_SpinnerTable;
+
+template<uint8_t Loops, uint8_t... DutyCycles, uint8_t... Segments>
+class VFD_SpinnerTable<Loops, VFD_SpinnerDuty<DutyCycles...>, Segments...>
+{
+public:
+    static constexpr uint8_t frames = sizeof...(Segments);
+    static constexpr uint8_t loops  = Loops;
+    static constexpr uint8_t fades  = sizeof...(DutyCycles);
+
+    /**
+     * @brief Get the segments of a frame.
+     * @param frame_number Frame to display (Value range 1..frames).
+     * @param loop_number Refresh of the frame (Value range 0..loops - 1).
+     * @return 16 bits word of segments.
+     */
+    static inline uint16_t word(uint8_t frame_number, uint8_t loop_number)
+    {
+        uint8_t fade_flags = pgm_read_byte(&LoopFadesTable::values[loop_number]);
+        return pgm_read_word(&FrameWordsTable::values[((frame_number - 1) << fades) | fade_flags]);
+    }
+
+private:
+    static_assert(frames > 0, "At least 1 segment is required");
+    static_assert(fades < 8, "Too many fading segments");
+
+    static constexpr bool validSegments(uint8_t index = 0)
+    {
+        return (index == frames)
+               || ((VFD_spinnerSegmentAt(index, Segments...) >= 1)
+                   && (VFD_spinnerSegmentAt(index, Segments...) <= 16)
+                   && validSegments(index + 1));
+    }
+
+    static constexpr uint16_t segmentBit(int16_t index)
+    {
+        return (index < 0) ? 0 : (1U << (VFD_spinnerSegmentAt(index, Segments...) - 1));
+    }
+
+    // Main segment of the frame + fading segments selected by the given flags
+    static constexpr uint16_t frameWord(uint8_t frame, uint8_t fade_flags, uint8_t fade = 0)
+    {
+        return (fade == fades)
+               ? segmentBit(frame)
+               : ((((fade_flags >> fade) & 1) ? segmentBit(frame - fade - 1) : 0)
+                  | frameWord(frame, fade_flags, fade + 1));
+    }
+
+    struct LoopFades
+    {
+        typedef uint8_t value_type;
+        static constexpr uint8_t value(uint16_t loop_number)
+        {
+            return VFD_spinnerFadeFlags(loop_number, 0, DutyCycles...);
+        }
+    };
+
+    struct FrameWords
+    {
+        typedef uint16_t value_type;
+        static constexpr uint16_t value(uint16_t index)
+        {
+            return frameWord(index >> fades, index & ((1 << fades) - 1));
+        }
+    };
+
+    typedef VFD_ProgmemTable<LoopFades, Loops> LoopFadesTable;
+    typedef VFD_ProgmemTable<FrameWords, (frames << fades)> FrameWordsTable;
+
+    static_assert(validSegments(), "Segment numbers must be in range 1..16");
+};
+
+#endif
@@ -0,0 +1,93 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Instrumentation of the bus (see VFD_STATS and VFD_TRACE_HOOKS in global.h).
+ *
+ * The counters are updated by the driver (see PT6312::command(), txSend(), receive(),
+ * readByte()), the hooks are called by txSend(): with the transmit queue, they follow
+ * the bytes actually sent by the timer interrupt.
+ * Nothing is compiled if the options are disabled.
+ */
+#include "PT6312.h"
+
+#if VFD_STATS == 1
+
+VFD_Stats VFD_stats;
+
+
+/**
+ * @brief Clear the counters of VFD_stats.
+ * @note The counters are updated by the timer interrupt too (background features,
+ *      transmit queue): disable the interrupts around the reset and the reads
+ *      for consistent values.
+ */
+void VFD_statsReset(void)
+{
+    VFD_stats = VFD_Stats();
+}
+
+
+/**
+ * @brief Clock of the cycle counters of VFD_stats.
+ *      Default implementation (weak symbol), to be replaced by the program
+ *      if the MCU has a better clock (Ex: return micros() * (F_CPU / 1000000UL);).
+ *      - host & Linux backends: clock of the backend, converted to cycles of F_CPU;
+ *      - MCU with ENABLE_TIMER: timer of the background features (resolution: prescaler);
+ *      - MCU without ENABLE_TIMER: not available, always 0.
+ * @return CPU cycles elapsed since an arbitrary origin; only the differences are used,
+ *      overflows included.
+ */
+__attribute__((weak)) uint32_t VFD_statsCycles(void)
+{
+    #if defined(VFD_HOST)
+    return VFD_hostNanos() * (F_CPU / 1000000UL) / 1000UL;
+    #elif defined(VFD_LINUX)
+    return VFD_linuxNanos() * (F_CPU / 1000000UL) / 1000UL;
+    #elif ENABLE_TIMER == 1
+    return VFD_timerCycles();
+    #else
+    return 0;
+    #endif
+}
+
+#endif
+
+#if VFD_TRACE_HOOKS == 1
+
+/**
+ * @brief Called by the driver before the CS/Strobe line goes LOW (start of transmission).
+ *      Empty by default (weak symbol), to be replaced by the program.
+ *      Ex: set a spare pin HIGH, the transactions are seen on a scope/logic analyzer
+ *      including the time spent by the library around the bus signals.
+ * @note Called from the timer interrupt for the transmissions of the background features
+ *      and of the transmit queue: keep it short.
+ */
+__attribute__((weak)) void VFD_transactionBegin(void)
+{
+}
+
+
+/**
+ * @brief Called by the driver after the CS/Strobe line goes HIGH (end of transmission).
+ *      Empty by default (weak symbol), to be replaced by the program.
+ * @see VFD_transactionBegin()
+ */
+__attribute__((weak)) void VFD_transactionEnd(void)
+{
+}
+
+#endif
@@ -0,0 +1,200 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Timer interrupt of the background features (see ENABLE_TIMER in global.h).
+ */
+#include "PT6312.h"
+
+#if ENABLE_TIMER == 1
+
+// Number of CPU cycles between 2 interrupts
+#define VFD_TIMER_CYCLES    (F_CPU / VFD_TIMER_FREQUENCY)
+
+#if defined(VFD_HOST)
+/**
+ * Host backend: interrupt emulated on the virtual clock (see host/host_hal.h).
+ */
+#define VFD_TIMER_VECT      VFD_HOST_TIMER_vect
+
+#elif defined(VFD_LINUX)
+/**
+ * Linux backend: interrupt called by the delays & VFD_linuxPoll() (see linux/linux_hal.h).
+ */
+#define VFD_TIMER_VECT      VFD_LINUX_TIMER_vect
+
+#elif defined(TCCR1) && defined(OCR1C)
+/**
+ * ATtiny25/45/85: Timer1 in CTC mode (cleared on OCR1C match).
+ * Prescalers are powers of 2: clock select n gives F_CPU / 2^(n-1).
+ * @return Smallest clock select for which the compare value fits in 8 bits.
+ */
+static constexpr uint8_t VFD_timerClockSelect(uint32_t cycles, uint8_t cs = 1)
+{
+    return (cycles <= 256UL || cs == 15) ? cs : VFD_timerClockSelect(cycles >> 1, cs + 1);
+}
+static constexpr uint8_t VFD_timerShift(uint8_t cs)
+{
+    return cs - 1;
+}
+#define VFD_TIMER_VECT      TIMER1_COMPA_vect
+
+#elif defined(TCCR2A) && defined(OCR2A)
+/**
+ * ATmega: Timer2 in CTC mode (cleared on OCR2A match).
+ * Prescalers: 1, 8, 32, 64, 128, 256, 1024 for clock selects 1..7.
+ */
+static constexpr uint8_t VFD_timerShift(uint8_t cs)
+{
+    return (cs == 1) ? 0 : (cs == 2) ? 3 : (cs == 3) ? 5 : (cs == 7) ? 10 : cs + 2;
+}
+/**
+ * @return Smallest clock select for which the compare value fits in 8 bits.
+ */
+static constexpr uint8_t VFD_timerClockSelect(uint32_t cycles, uint8_t cs = 1)
+{
+    return ((cycles >> VFD_timerShift(cs)) <= 256UL || cs == 7) ? cs : VFD_timerClockSelect(cycles, cs + 1);
+}
+#define VFD_TIMER_VECT      TIMER2_COMPA_vect
+
+#else
+    #error "No supported timer for ENABLE_TIMER on this MCU!"
+#endif
+
+#if !defined(VFD_HOST) && !defined(VFD_LINUX)
+static constexpr uint8_t VFD_TIMER_CS  = VFD_timerClockSelect(VFD_TIMER_CYCLES);
+static_assert((VFD_TIMER_CYCLES >> VFD_timerShift(VFD_TIMER_CS)) <= 256UL,
+              "VFD_TIMER_FREQUENCY is too low for F_CPU");
+static_assert((VFD_TIMER_CYCLES >> VFD_timerShift(VFD_TIMER_CS)) > 1UL,
+              "VFD_TIMER_FREQUENCY is too high for F_CPU");
+static constexpr uint8_t VFD_TIMER_TOP = (VFD_TIMER_CYCLES >> VFD_timerShift(VFD_TIMER_CS)) - 1;
+// Actual number of CPU cycles between 2 interrupts: VFD_TIMER_CYCLES rounded down
+// to the resolution of the timer (Ex: 422.3 Hz instead of 420 Hz at 8 MHz)
+static constexpr uint32_t VFD_TIMER_PERIOD = (VFD_TIMER_TOP + 1UL) << VFD_timerShift(VFD_TIMER_CS);
+
+#if VFD_STATS == 1
+// Number of interrupts since VFD_timerStart() (see VFD_timerCycles())
+static volatile uint32_t vfd_timer_periods;
+#endif
+#else
+// Emulated timer: period given in nanoseconds to the backend
+static constexpr uint32_t VFD_TIMER_PERIOD = VFD_TIMER_CYCLES;
+#endif
+
+
+/**
+ * @brief Start the timer interrupt at VFD_TIMER_FREQUENCY.
+ *      Called by VFD_initialize().
+ * @note Global interrupts must be enabled (sei(), already done by the Arduino core).
+ */
+void VFD_timerStart(void)
+{
+    #if defined(VFD_HOST)
+    VFD_hostTimerStart(VFD_TIMER_VECT, VFD_TIMER_PERIOD * 1000000000ULL / F_CPU);
+    #elif defined(VFD_LINUX)
+    VFD_linuxTimerStart(VFD_TIMER_VECT, VFD_TIMER_PERIOD * 1000000000ULL / F_CPU);
+    #elif defined(TCCR1) && defined(OCR1C)
+    TCCR1 = 0;
+    TCNT1 = 0;
+    OCR1C = VFD_TIMER_TOP;
+    OCR1A = VFD_TIMER_TOP;
+    TIMSK |= (1 << OCIE1A);
+    TCCR1 = (1 << CTC1) | VFD_TIMER_CS;
+    #else
+    TCCR2B = 0;
+    TCNT2  = 0;
+    OCR2A  = VFD_TIMER_TOP;
+    TCCR2A = (1 << WGM21);
+    TIMSK2 |= (1 << OCIE2A);
+    TCCR2B = VFD_TIMER_CS;
+    #endif
+}
+
+
+#if VFD_STATS == 1 && !defined(VFD_HOST) && !defined(VFD_LINUX)
+/**
+ * @brief Get the CPU cycles elapsed since VFD_timerStart(), from the counter of the timer.
+ *      Clock of VFD_statsCycles() on the MCU.
+ * @return Number of cycles, rounded to the prescaler of the timer.
+ */
+uint32_t VFD_timerCycles(void)
+{
+    uint8_t sreg = SREG;
+    cli();
+    uint32_t periods = vfd_timer_periods;
+    #if defined(TCCR1) && defined(OCR1C)
+    uint8_t count = TCNT1;
+    bool pending = TIFR & (1 << OCF1A);
+    #else
+    uint8_t count = TCNT2;
+    bool pending = TIFR2 & (1 << OCF2A);
+    #endif
+    SREG = sreg;
+
+    // Compare match not serviced yet: the counter has been cleared
+    if (pending && count < VFD_TIMER_TOP) {
+        periods++;
+    }
+    return periods * VFD_TIMER_PERIOD + ((uint32_t)count << VFD_timerShift(VFD_TIMER_CS));
+}
+#endif
+
+
+/**
+ * @brief Test if the background features can use the bus, called by the timer interrupt.
+ *      Default implementation (weak symbol): only the CS/Strobe line of the default
+ *      driver is tested (see PT6312::isBusIdle()). With several controllers on a shared
+ *      bus, it must be replaced by the program to test all the CS/Strobe lines,
+ *      Ex: bool VFD_busIdle(void) { return Displays::isIdle(); }
+ */
+__attribute__((weak)) bool VFD_busIdle(void)
+{
+    return VFD_Driver::isBusIdle();
+}
+
+
+/**
+ * Timer interrupt: steps of the background features, then bytes of the transmit queue
+ */
+ISR(VFD_TIMER_VECT)
+{
+    #if VFD_STATS == 1 && !defined(VFD_HOST) && !defined(VFD_LINUX)
+    vfd_timer_periods++;
+    #endif
+
+    #if VFD_TX_QUEUE_SIZE > 0
+    // The background features only use the bus when the queue is empty (see VFD_busIdle()):
+    // their transmissions are direct
+    bool direct = vfd_tx_direct;
+    vfd_tx_direct = true;
+    #endif
+
+    VFD_spinnerInterrupt();
+    VFD_fadeInterrupt();
+    #if VFD_CLOCK_TIMER == 1
+    VFD_clockInterrupt(VFD_TIMER_PERIOD);
+    #endif
+    #if ENABLE_KEY_SCANNER == 1
+    VFD_keyScannerInterrupt();
+    #endif
+
+    #if VFD_TX_QUEUE_SIZE > 0
+    vfd_tx_direct = direct;
+    VFD_txInterrupt();
+    #endif
+}
+
+#endif
@@ -0,0 +1,166 @@
+/* PT6312 is an Arduino library for the PT6312 family of Vacuum Fluorescent Display controllers.
+ * Copyright (C) 2022 Ysard - <ysard@users.noreply.github.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/* Transmit queue (see VFD_TX_QUEUE_SIZE in global.h).
+ *
+ * The transmissions of the main program are queued byte by byte, with the framing of
+ * the CS/Strobe line, and sent by the timer interrupt (VFD_TX_BURST bytes per interrupt):
+ * the drawing functions return without waiting for the bus.
+ * The reads (keys, switches) are synchronous: the queue is emptied first (see VFD_txFence()).
+ */
+#include "PT6312.h"
+
+#if VFD_TX_QUEUE_SIZE > 0
+
+#if ENABLE_TIMER != 1
+    #error "VFD_TX_QUEUE_SIZE requires ENABLE_TIMER!"
+#endif
+
+static_assert(VFD_TX_QUEUE_SIZE >= 4 && VFD_TX_QUEUE_SIZE <= 128 && (VFD_TX_QUEUE_SIZE & (VFD_TX_QUEUE_SIZE - 1)) == 0,
+              "VFD_TX_QUEUE_SIZE must be a power of 2 in 4..128");
+static_assert(VFD_TX_BURST >= 1 && VFD_TX_BURST < VFD_TX_QUEUE_SIZE - 1,
+              "VFD_TX_BURST must be in 1..VFD_TX_QUEUE_SIZE - 2");
+
+volatile bool vfd_tx_direct;
+
+/**
+ * Queue of transmission steps (see PT6312::txSend()): single producer (main program),
+ * single consumer (timer interrupt, or the main program while draining is set).
+ * head is only written by the producer, tail by the consumer; a slot is kept
+ * empty to distinguish a full queue from an empty one.
+ */
+static struct {
+    uint8_t          values[VFD_TX_QUEUE_SIZE];
+    uint8_t          flags[VFD_TX_QUEUE_SIZE];  // VFD_TX_* flags, index of the controller in the 4 MSB
+    volatile uint8_t head;
+    volatile uint8_t tail;
+    volatile bool    draining;                  // The main program sends the queued bytes itself
+} tx_queue;
+
+// Transmission functions of the controllers (see VFD_txRegister())
+static VFD_TxSender tx_senders[VFD_TX_SENDERS];
+static uint8_t      tx_senders_count;
+
+
+/**
+ * @brief Register the transmission function of a controller.
+ *      Called by PT6312::configurePins().
+ * @param sender Function performing a step of a transmission (see PT6312::txSend()).
+ * @return Index of the controller in the queue;
+ *      VFD_TX_SENDERS if there are too many controllers: its transmissions are not queued.
+ */
+uint8_t VFD_txRegister(VFD_TxSender sender)
+{
+    uint8_t index = 0;
+    while ((index < tx_senders_count) && (tx_senders[index] != sender)) {
+        index++;
+    }
+    if ((index == tx_senders_count) && (index < VFD_TX_SENDERS)) {
+        tx_senders[index] = sender;
+        tx_senders_count++;
+    }
+    return index;
+}
+
+
+/**
+ * @brief Send the oldest step of the queue, if any.
+ */
+static void VFD_txSendNext(void)
+{
+    uint8_t tail = tx_queue.tail;
+
+    if (tail == tx_queue.head) {
+        return;
+    }
+
+    uint8_t flags = tx_queue.flags[tail];
+    tx_senders[flags >> 4](tx_queue.values[tail], flags & 0x0F);
+
+    // The step leaves the queue once it is sent: the bus is busy until then
+    tx_queue.tail = (tail + 1) & (VFD_TX_QUEUE_SIZE - 1);
+}
+
+
+/**
+ * @brief Queue a step of a transmission.
+ *      If the queue is full, the oldest step is sent first by the main program.
+ * @param value Byte to send (if VFD_TX_DATA is set).
+ * @param flags VFD_TX_* flags, index of the controller in the 4 MSB.
+ */
+void VFD_txPush(uint8_t value, uint8_t flags)
+{
+    uint8_t head = tx_queue.head;
+    uint8_t next = (head + 1) & (VFD_TX_QUEUE_SIZE - 1);
+
+    if (next == tx_queue.tail) {
+        tx_queue.draining = true;
+        VFD_txSendNext();
+        tx_queue.draining = false;
+    }
+
+    tx_queue.values[head] = value;
+    tx_queue.flags[head]  = flags;
+    tx_queue.head         = next;
+}
+
+
+/**
+ * @brief Test if all the queued bytes are sent.
+ */
+bool VFD_txEmpty(void)
+{
+    return tx_queue.head == tx_queue.tail;
+}
+
+
+/**
+ * @brief Wait for the queued bytes to be sent: they are sent by the caller,
+ *      without waiting for the timer interrupt.
+ *      To be used before the code that needs the transmissions to be done
+ *      (Ex: raw reads, timing measurements, sleep mode); the reads of the library
+ *      (keys, switches) already call it.
+ * @warning Not to be called with an open transmission (see VFD_command()):
+ *      the CS/Strobe line stays LOW.
+ */
+void VFD_txFence(void)
+{
+    tx_queue.draining = true;
+    while (tx_queue.tail != tx_queue.head) {
+        VFD_txSendNext();
+    }
+    tx_queue.draining = false;
+}
+
+
+/**
+ * @brief Send up to VFD_TX_BURST queued bytes.
+ *      Called by the timer interrupt.
+ *      Nothing is sent while the main program empties the queue itself.
+ */
+void VFD_txInterrupt(void)
+{
+    if (tx_queue.draining) {
+        return;
+    }
+
+    for (uint8_t i = 0; (i < VFD_TX_BURST) && (tx_queue.tail != tx_queue.head); i++) {
+        VFD_txSendNext();
+    }
+}
+
+#endif